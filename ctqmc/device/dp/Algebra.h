@@ -109,6 +109,7 @@ namespace imp {
     struct Vector<Device> {
         Vector() = delete;
         Vector(double time, Energies<Device> const& energies);
+        Vector(double time, Energies<Device> const& energies, Memory&) : Vector(time, energies) {}; // device memory is recycled by device::Allocator
         Vector(Vector const&) = delete;
         Vector(Vector&&) = delete;
         Vector& operator=(Vector const&) = delete;
@@ -135,6 +136,7 @@ namespace imp {
         
         Matrix() = delete;
         Matrix(int size);
+        Matrix(int size, Memory&) : Matrix(size) {};
         Matrix(Identity const& identity);
         Matrix(Zero const& zero);
         Matrix(int I, int J, io::rmat const& mat);
@@ -3,9 +3,21 @@
 
 #include <stdexcept>
 #include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <algorithm>
 
 #include "../include/Utilities.h"
 #include "../include/impurity/Algebra.h"
+#include "../include/impurity/Memory.h"
+#include "Simd.h"
+#include "SmallGemm.h"
+#include "Sparse.h"
 
 #include "../../include/BlasLapack.h"
 #include "../../include/JsonX.h"
@@ -15,18 +27,98 @@ namespace imp {
 
     struct Host {};    
     
+    namespace batch {
+        
+        struct Settings {
+            int threads = 1;
+        };
+        
+        //Set before the Markov chains are created
+        inline Settings& settings() { static Settings settings; return settings;};
+        
+    }
+    
+    //With "sector threads" > 1 the density matrix hands that many sectors over at once (c.f. DensityMatrix::decide). The operations of each
+    //sector are recorded as one task, and launch runs the tasks on the worker threads of the Markov chain and the calling thread. Everything
+    //else, in particular all allocations, still happens immediately on the thread of the Markov chain.
     template<typename Value>
     struct Batcher<Host, Value> : itf::Batcher<Value> {
         Batcher() = delete;
-        Batcher(std::size_t) {};
+        Batcher(std::size_t) : Batcher(0, batch::settings().threads) {};
+        Batcher(std::size_t, int threads) :
+        threads_(std::max(threads, 1)), recording_(false),
+        round_(0), busy_(0), stop_(false), next_(0) {
+            for(int t = 1; t < threads_; ++t) workers_.emplace_back(&Batcher::work, this);
+        };
         Batcher(Batcher const&) = delete;
         Batcher(Batcher&&) = delete;
         Batcher& operator=(Batcher const&) = delete;
         Batcher& operator=(Batcher&&) = delete;
-        ~Batcher() = default;
+        ~Batcher() {
+            { std::lock_guard<std::mutex> lock(mutex_); stop_ = true;}
+            start_.notify_all(); for(auto& worker : workers_) worker.join();
+        };
         
         int is_ready() { return 1;};
-        void launch() {};
+        void launch() {
+            recording_ = false; if(tasks_.size() == 0) return;
+            
+            { std::lock_guard<std::mutex> lock(mutex_); next_ = 0; busy_ = workers_.size(); ++round_;}
+            start_.notify_all(); run();
+            
+            { std::unique_lock<std::mutex> lock(mutex_); done_.wait(lock, [this]() { return busy_ == 0;});}
+            tasks_.clear();
+            
+            if(error_) {
+                auto error = error_; error_ = nullptr; std::rethrow_exception(error);
+            }
+        };
+        
+        int sectors() const { return threads_;};
+        void task() {
+            if(threads_ > 1) { recording_ = true; tasks_.emplace_back();}
+        };
+        
+        //Appends op to the current task and returns true if the batcher records, else the caller has to do the operation itself.
+        //The arguments op captures by reference outlive the task, they are owned by the product or the density matrix.
+        template<typename Op>
+        bool record(Op const& op) {
+            if(!recording_) return false;
+            tasks_.back().push_back(op); return true;
+        };
+        
+    private:
+        int const threads_;
+        bool recording_;
+        std::vector<std::vector<std::function<void()>>> tasks_;
+        
+        std::vector<std::thread> workers_;
+        std::mutex mutex_; std::condition_variable start_, done_;
+        std::int64_t round_; std::size_t busy_; bool stop_;
+        std::atomic<std::size_t> next_;
+        std::exception_ptr error_;
+        
+        void run() {
+            for(std::size_t t = next_++; t < tasks_.size(); t = next_++) {
+                try {
+                    for(auto& op : tasks_[t]) op();
+                } catch(...) {
+                    std::lock_guard<std::mutex> lock(mutex_); if(!error_) error_ = std::current_exception();
+                }
+            }
+        };
+        
+        void work() {
+            for(std::int64_t round = 0;;) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_); start_.wait(lock, [&]() { return stop_ || round_ != round;});
+                    if(stop_) return;
+                    round = round_;
+                }
+                run();
+                { std::lock_guard<std::mutex> lock(mutex_); --busy_;} done_.notify_one();
+            }
+        };
     };
     
     
@@ -73,15 +165,25 @@ namespace imp {
         Vector(double time, Energies<Host> const& energies) :
         time_(time),
         exponent_(time*energies.min()),
-        data_(new double[energies.dim()])  {
-            for(int i = 0; i < energies.dim(); ++i) data_[i] = std::exp(time*energies.data()[i] - exponent_);
+        size_(energies.dim()),
+        data_(new double[size_]),
+        memory_(nullptr) {
+            init(energies);
+        };
+        Vector(double time, Energies<Host> const& energies, Memory& memory) :
+        time_(time),
+        exponent_(time*energies.min()),
+        size_(energies.dim()),
+        data_(memory.allocate<double>(size_)),
+        memory_(&memory) {
+            init(energies);
         };
         Vector(Vector const&) = delete;
         Vector(Vector&&) = delete;
         Vector& operator=(Vector const&) = delete;
         Vector& operator=(Vector&&) = delete;
         ~Vector() {
-            delete[] data_;
+            if(memory_) memory_->free(data_, size_); else delete[] data_;
         };
         
         double const& time() const { return time_;};
@@ -92,7 +194,13 @@ namespace imp {
     private:
         double const time_;
         double const exponent_;
+        int const size_;
         double* data_;
+        Memory* const memory_;
+        
+        void init(Energies<Host> const& energies) {
+            simd::exp(data_, energies.data(), time_, exponent_, size_);
+        };
     };
     
     template<typename Value>
@@ -102,24 +210,27 @@ namespace imp {
         
         Matrix() = delete;
         Matrix(int size):
-        data_(new Value[size]) {
+        data_(new Value[size]), size_(size), memory_(nullptr) {
+        };
+        Matrix(int size, Memory& memory):
+        data_(memory.allocate<Value>(size)), size_(size), memory_(&memory) {
         };
         Matrix(Identity const& identity) :
         I_(identity.dim), J_(identity.dim),
-        data_(new Value[I_*J_]),
+        data_(new Value[I_*J_]), size_(I_*J_), memory_(nullptr),
         exponent_(.0) {
             std::memset(data_, 0, I_*J_*sizeof(Value)); //huere memset isch das allgemein für double's ?
             for(int i = 0; i < identity.dim; ++i) data_[i*(identity.dim + 1)] = 1.;
         };
         Matrix(Zero const& zero) :
         I_(zero.dim), J_(zero.dim),
-        data_(new Value[I_*J_]),
+        data_(new Value[I_*J_]), size_(I_*J_), memory_(nullptr),
         exponent_(.0) {
             std::memset(data_, 0, I_*J_*sizeof(Value)); //huere memset isch das allgemein für double's ?
         };
         Matrix(int I, int J, io::Matrix<Value> const& matrix) :
         I_(I), J_(J),
-        data_(new Value[I_*J_]),
+        data_(new Value[I_*J_]), size_(I_*J_), memory_(nullptr),
         exponent_(.0) {
             for(int i = 0; i < I; ++i)
                 for(int j = 0; j < J; ++j)
@@ -130,7 +241,7 @@ namespace imp {
         Matrix& operator=(Matrix const&) = delete;
         Matrix& operator=(Matrix&&) = delete;
         ~Matrix() {
-            delete[] data_;
+            if(memory_) memory_->free(data_, size_); else delete[] data_;
         }
         
         int& I() { return I_;}
@@ -142,23 +253,59 @@ namespace imp {
         double& exponent() { return exponent_;}
         double const& exponent() const { return exponent_;}
         
+        //Compressed copy of data, only set for constant matrices (the operator blocks, c.f. sparsify)
+        sparse::Csr<Value> const* sparse() const { return sparse_.get();}
+        void sparse(sparse::Csr<Value>* csr) { sparse_.reset(csr);}
+        
     private:
         int I_, J_;
         Value* data_;
+        int const size_;
+        Memory* const memory_;
         double exponent_;
+        std::unique_ptr<sparse::Csr<Value>> sparse_;
+    };
+    
+    
+    //Keeps a compressed copy of the operator block if at most the fraction fill of its entries is non-zero, such that products with it
+    //as left factor cost O(non-zeros x J) instead of O(I x K x J). Returns true if the block is stored sparse.
+    template<typename Value>
+    bool sparsify(Matrix<Host, Value>& matrix, double fill) {
+        if(matrix.I()*matrix.J() == 0 || sparse::non_zeros(matrix.data(), matrix.I(), matrix.J()) > fill*matrix.I()*matrix.J()) return false;
+        
+        matrix.sparse(new sparse::Csr<Value>(matrix.data(), matrix.I(), matrix.J()));
+        return true;
     };
     
     
+    //dest = diag(prop)*source for source of dimension I x K (row major)
+    template<typename Value>
+    void scale_rows(Value* dest, double const* prop, Value const* source, int I, int K) {
+        for(int i = 0; i < I; ++i) {
+            double const p = prop[i]; Value const* s = source + i*K; Value* d = dest + i*K;
+            for(int k = 0; k < K; ++k) d[k] = p*s[k];
+        }
+    };
+    
     template<typename Value>
     void copyEvolveL(Matrix<Host, Value>& dest, Vector<Host> const& prop, Matrix<Host, Value> const& source, itf::Batcher<Value>& batcher) {
-        dest.I() = source.I(); dest.J() = source.J(); dest.exponent() = source.exponent() + prop.exponent(); int const inc = 1; // eigentli source.exponent_ = 0 wil basis-operator, isch aber sicherer so.
-        std::memset(dest.data(), 0, dest.I()*dest.J()*sizeof(Value));
-        for(int i = 0; i < source.I(); ++i) axpy(&source.J(), prop.data() + i, source.data() + i*source.J(), &inc, dest.data() + i*dest.J(), &inc);
+        if(get<Host>(batcher).record([&dest, &prop, &source, &batcher]() { copyEvolveL(dest, prop, source, batcher);})) return;
+        
+        dest.I() = source.I(); dest.J() = source.J(); dest.exponent() = source.exponent() + prop.exponent(); // eigentli source.exponent_ = 0 wil basis-operator, isch aber sicherer so.
+        scale_rows(dest.data(), prop.data(), source.data(), source.I(), source.J());
     };
     
     template<typename Value>
     void mult(Matrix<Host, Value>& dest, Matrix<Host, Value> const& L, Matrix<Host, Value> const& R, itf::Batcher<Value>& batcher) {
+        if(get<Host>(batcher).record([&dest, &L, &R, &batcher]() { mult(dest, L, R, batcher);})) return;
+        
         dest.I() = L.I(); dest.J() = R.J(); dest.exponent() = L.exponent() + R.exponent();
+        if(L.sparse()) {
+            sparse::mult(dest.data(), nullptr, *L.sparse(), R.data(), L.I(), R.J()); return;
+        }
+        if(small::is_small(L.I(), L.J(), R.J())) {
+            small::mult<Value>(dest.data(), nullptr, L.data(), R.data(), L.I(), L.J(), R.J()); return;
+        }
         char transNo = 'n'; Value one = 1.; Value zero = .0;
         gemm(&transNo, &transNo, &R.J(), &L.I(), &L.J(), &one, R.data(), &R.J(), L.data(), &L.J(), &zero, dest.data(), &dest.J());
     };
@@ -169,8 +316,31 @@ namespace imp {
         for(int i = 0; i < arg.I(); ++i) scal(&arg.J(), prop.data() + i, arg.data() + i*arg.J(), &inc);
     };
     
+    //Sparse and small products scale the rows of L on the fly, larger ones scale L into a scratch buffer and go to BLAS. Either
+    //way dest is written once, instead of a gemm followed by a scal per row (c.f. bench/SmallGemm.C).
+    template<typename Value>
+    void multEvolveL(Matrix<Host, Value>& dest, Vector<Host> const& prop, Matrix<Host, Value> const& L, Matrix<Host, Value> const& R, itf::Batcher<Value>& batcher) {
+        if(get<Host>(batcher).record([&dest, &prop, &L, &R, &batcher]() { multEvolveL(dest, prop, L, R, batcher);})) return;
+        
+        dest.I() = L.I(); dest.J() = R.J(); dest.exponent() = L.exponent() + R.exponent() + prop.exponent();
+        if(L.sparse()) {
+            sparse::mult(dest.data(), prop.data(), *L.sparse(), R.data(), L.I(), R.J()); return;
+        }
+        if(small::is_small(L.I(), L.J(), R.J())) {
+            small::mult(dest.data(), prop.data(), L.data(), R.data(), L.I(), L.J(), R.J()); return;
+        }
+        
+        static thread_local std::vector<Value> scaled; scaled.resize(L.I()*L.J());  // scratch, one per thread of Markov chains
+        scale_rows(scaled.data(), prop.data(), L.data(), L.I(), L.J());
+        
+        char transNo = 'n'; Value one = 1.; Value zero = .0;
+        gemm(&transNo, &transNo, &R.J(), &L.I(), &L.J(), &one, R.data(), &R.J(), scaled.data(), &L.J(), &zero, dest.data(), &dest.J());
+    };
+    
     template<typename Value>
     void trace(ut::Zahl<Value>* Z, ut::Zahl<Value>* accZ, Matrix<Host, Value> const& matrix, itf::Batcher<Value>& batcher) {
+        if(get<Host>(batcher).record([Z, accZ, &matrix, &batcher]() { trace(Z, accZ, matrix, batcher);})) return;
+        
         Value sum = .0; for(int i = 0; i < matrix.I(); ++i) sum += matrix.data()[(matrix.I() + 1)*i];
         ut::Zahl<Value> temp(sum, matrix.exponent()); if(Z) *Z = temp; if(accZ) *accZ += temp;
     };
@@ -185,6 +355,8 @@ namespace imp {
     
     template<typename Value>
     void norm(double* norm, Matrix<Host, Value> const& matrix, itf::Batcher<Value>& batcher) {
+        if(get<Host>(batcher).record([norm, &matrix, &batcher]() { imp::norm(norm, matrix, batcher);})) return;
+        
         int inc = 1; int n = matrix.I()*matrix.J();
         *norm = std::log(nrm2(&n, matrix.data(), &inc)) + matrix.exponent();
     };
@@ -197,11 +369,9 @@ namespace imp {
         
         dest.exponent() += prop.exponent(); double const deltaTime = -prop.time(); // this is confusing, change time -> -time
         auto d = dest.data(); auto const p = prop.data(); auto const e = energies.data();
+        static thread_local std::vector<double> factors; factors.resize(dest.J());  // scratch, one per thread of Markov chains
         for(int i = 0; i < dest.I(); ++i)
-            for(int j = 0; j < dest.J(); ++j) {
-                double const deltaE = e[j] - e[i]; double const delta = deltaTime*deltaE;
-                d[j + dest.J()*i] *= std::abs(delta) > 1.e-7 ? (p[i] - p[j])/deltaE : deltaTime/2.*(p[i] + p[j] + delta/2.*(p[j] - p[i])); //approximation is symmetric
-            }
+            simd::density_scale(d + dest.J()*i, e, p, e[i], p[i], deltaTime, dest.J(), factors.data());
     };
     
     template<typename Value>
@@ -0,0 +1,178 @@
+#ifndef CTQMC_HOST_MIXED_H
+#define CTQMC_HOST_MIXED_H
+
+#include <cstdint>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <algorithm>
+
+#include "Algebra.h"
+
+//Mixed precision variant of the host mode ("precision" : "mixed"). The matrices are stored in double as for imp::Host, but the dense
+//products of the trace (mult and multEvolveL of large blocks) convert their factors to single precision, each scaled by a power of two such
+//that its largest entry is of order one, and convert the result back. Propagators, traces, norms, bounds and density matrices stay in double.
+//
+//Every "precision check" single precision products a Markov chain recomputes the product in double and compares the two (relative Frobenius
+//norm). If the difference exceeds "precision tolerance" the chain does all further products in double.
+
+namespace imp {
+
+    struct HostMixed {};
+
+    namespace mixed {
+
+        struct Settings {
+            std::int64_t check = 1000;
+            double tolerance = 1.e-3;
+        };
+
+        //Set before the Markov chains are created
+        inline Settings& settings() { static Settings settings; return settings;};
+
+
+        template<typename Value> struct Single;
+        template<> struct Single<double> { using type = float;};
+        template<> struct Single<ut::complex> { using type = std::complex<float>;};
+
+        //Below this the conversions cost more than single precision saves (about 2x for sgemm vs dgemm)
+        inline bool is_large(int I, int K, int J) {
+            return static_cast<std::int64_t>(I)*K*J >= 128*128*128;
+        };
+
+        inline double magnitude(double x) { return std::abs(x);};
+        inline double magnitude(ut::complex const& z) { return std::max(std::abs(z.real()), std::abs(z.imag()));};
+
+        //dest = source/scale with scale the power of two 2^exp closest above the largest entry, returns scale
+        template<typename Value>
+        double convert(std::vector<typename Single<Value>::type>& dest, Value const* source, int size) {
+            double max[4] = {.0, .0, .0, .0}; int n = 0;  // independent maxima, such that the loop pipelines
+            for(; n + 4 <= size; n += 4)
+                for(int k = 0; k < 4; ++k) max[k] = std::max(max[k], magnitude(source[n + k]));
+            for(; n < size; ++n) max[0] = std::max(max[0], magnitude(source[n]));
+
+            int exp = 0; double const m = std::max(std::max(max[0], max[1]), std::max(max[2], max[3])); if(m > .0) std::frexp(m, &exp);
+
+            double const inverse = std::ldexp(1., -exp);
+            dest.resize(size); for(int n = 0; n < size; ++n) dest[n] = static_cast<typename Single<Value>::type>(inverse*source[n]);
+            return std::ldexp(1., exp);
+        };
+
+    }
+
+
+    //Derives from the host batcher since the remaining algebra is the one of imp::Host, with a single thread it never records
+    template<typename Value>
+    struct Batcher<HostMixed, Value> : Batcher<Host, Value> {
+        Batcher() = delete;
+        Batcher(std::size_t) :
+        Batcher<Host, Value>(0, 1),
+        check_(mixed::settings().check), tolerance_(mixed::settings().tolerance),
+        products_(0), checks_(0), fallbacks_(0), error_(.0), precise_(false) {
+        };
+        Batcher(Batcher const&) = delete;
+        Batcher(Batcher&&) = delete;
+        Batcher& operator=(Batcher const&) = delete;
+        Batcher& operator=(Batcher&&) = delete;
+        ~Batcher() = default;
+
+        void precision(std::int64_t& checks, std::int64_t& fallbacks, double& error) const {
+            checks += checks_; fallbacks += fallbacks_; error = std::max(error, error_);
+        };
+
+        bool precise() const { return precise_;};
+
+        //dest = L*R with L of dimension I x K and R of dimension K x J (row major)
+        void mult(Value* dest, Value const* L, Value const* R, int I, int K, int J) {
+            double const scale = mixed::convert(L_, L, I*K)*mixed::convert(R_, R, K*J);
+
+            dest_.resize(I*J); char transNo = 'n'; Single one = 1., zero = .0;
+            gemm(&transNo, &transNo, &J, &I, &K, &one, R_.data(), &J, L_.data(), &K, &zero, dest_.data(), &J);
+            for(int n = 0; n < I*J; ++n) dest[n] = scale*static_cast<Value>(dest_[n]);
+
+            if(check_ > 0 && ++products_ % check_ == 0) check(dest, L, R, I, K, J);
+        };
+
+    private:
+        using Single = typename mixed::Single<Value>::type;
+
+        std::int64_t const check_;
+        double const tolerance_;
+
+        std::int64_t products_, checks_, fallbacks_;
+        double error_;
+        bool precise_;
+
+        std::vector<Single> L_, R_, dest_;
+        std::vector<Value> exact_;
+
+        void check(Value* dest, Value const* L, Value const* R, int I, int K, int J) {
+            exact_.resize(I*J); char transNo = 'n'; Value one = 1., zero = .0;
+            gemm(&transNo, &transNo, &J, &I, &K, &one, R, &J, L, &K, &zero, exact_.data(), &J);
+
+            double diff = .0, norm = .0;
+            for(int n = 0; n < I*J; ++n) {
+                diff += std::norm(dest[n] - exact_[n]); norm += std::norm(exact_[n]);
+            }
+
+            double const error = norm > .0 ? std::sqrt(diff/norm) : .0;
+            ++checks_; error_ = std::max(error_, error);
+            if(error > tolerance_) {
+                precise_ = true; ++fallbacks_;
+            }
+
+            std::copy(exact_.begin(), exact_.end(), dest);
+        };
+    };
+
+
+    template<>
+    struct Energies<HostMixed> : Energies<Host> {
+        using Energies<Host>::Energies;
+    };
+
+    template<>
+    struct Vector<HostMixed> : Vector<Host> {
+        using Vector<Host>::Vector;
+    };
+
+    template<typename Value>
+    struct Matrix<HostMixed, Value> : Matrix<Host, Value> {
+        using Matrix<Host, Value>::Matrix;
+    };
+
+
+    //The remaining algebra is the one of imp::Host (by derived to base conversion), only the dense products and the operator blocks are dispatched here
+    template<typename Value>
+    bool sparsify(Matrix<HostMixed, Value>& matrix, double fill) {
+        return sparsify(static_cast<Matrix<Host, Value>&>(matrix), fill);
+    };
+
+    template<typename Value>
+    void mult(Matrix<HostMixed, Value>& dest, Matrix<HostMixed, Value> const& L, Matrix<HostMixed, Value> const& R, itf::Batcher<Value>& batcher) {
+        auto& monitor = get<HostMixed>(batcher);
+        if(L.sparse() || monitor.precise() || !mixed::is_large(L.I(), L.J(), R.J())) {
+            mult(static_cast<Matrix<Host, Value>&>(dest), static_cast<Matrix<Host, Value> const&>(L), static_cast<Matrix<Host, Value> const&>(R), batcher); return;
+        }
+
+        dest.I() = L.I(); dest.J() = R.J(); dest.exponent() = L.exponent() + R.exponent();
+        monitor.mult(dest.data(), L.data(), R.data(), L.I(), L.J(), R.J());
+    };
+
+    template<typename Value>
+    void multEvolveL(Matrix<HostMixed, Value>& dest, Vector<HostMixed> const& prop, Matrix<HostMixed, Value> const& L, Matrix<HostMixed, Value> const& R, itf::Batcher<Value>& batcher) {
+        if(L.sparse() || get<HostMixed>(batcher).precise() || !mixed::is_large(L.I(), L.J(), R.J())) {
+            multEvolveL(static_cast<Matrix<Host, Value>&>(dest), static_cast<Vector<Host> const&>(prop), static_cast<Matrix<Host, Value> const&>(L), static_cast<Matrix<Host, Value> const&>(R), batcher); return;
+        }
+
+        static thread_local std::vector<Value> scaled; scaled.resize(L.I()*L.J());  // scratch, one per thread of Markov chains
+        scale_rows(scaled.data(), prop.data(), L.data(), L.I(), L.J());
+        
+        dest.I() = L.I(); dest.J() = R.J(); dest.exponent() = L.exponent() + R.exponent() + prop.exponent();
+        get<HostMixed>(batcher).mult(dest.data(), scaled.data(), R.data(), L.I(), L.J(), R.J());
+    };
+
+}
+
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef CTQMC_HOST_SIMD_H
+#define CTQMC_HOST_SIMD_H
+
+#include <cmath>
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+//Kernels for the exponentials of the propagators and the density matrix scaling. The instruction set is chosen at
+//build time from the compiler flags (e.g. -march=native, -mavx2 -mfma or -mavx512f), otherwise the plain loops are used.
+
+namespace imp {
+
+    namespace simd {
+
+        inline char const* name() {
+#if defined(__AVX512F__)
+            return "avx512";
+#elif defined(__AVX2__) && defined(__FMA__)
+            return "avx2";
+#else
+            return "none";
+#endif
+        };
+
+
+        //exp(x) = 2^n exp(r) with r = x - n ln2 and |r| <= ln2/2, where exp(r) is evaluated with the Taylor series up to r^13 (error below 1 ulp).
+        //Arguments below -708 are flushed to zero, which is fine here since all arguments are shifted such that the largest one is zero.
+
+        namespace exp_const {
+            double const log2e = 1.4426950408889634;
+            double const ln2hi = 6.93145751953125e-1;
+            double const ln2lo = 1.42860682030941723212e-6;
+            double const magic = 6755399441055744.;   // 1.5*2^52, rounds to integer in the lower mantissa bits
+            double const min   = -708.;
+            double const max   = 709.;
+
+            double const taylor[] = {
+                1./6227020800., 1./479001600., 1./39916800., 1./3628800., 1./362880., 1./40320., 1./5040.,
+                1./720., 1./120., 1./24., 1./6., 1./2., 1., 1.
+            };
+        }
+
+#if defined(__AVX512F__)
+
+        inline __m512d exp(__m512d x) {
+            using namespace exp_const;
+
+            __mmask8 const zero = _mm512_cmp_pd_mask(x, _mm512_set1_pd(min), _CMP_LT_OQ);
+            x = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(min)), _mm512_set1_pd(max));
+
+            __m512d const t = _mm512_fmadd_pd(x, _mm512_set1_pd(log2e), _mm512_set1_pd(magic));
+            __m512d const n = _mm512_sub_pd(t, _mm512_set1_pd(magic));
+            __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(ln2hi), x);
+            r = _mm512_fnmadd_pd(n, _mm512_set1_pd(ln2lo), r);
+
+            __m512d y = _mm512_set1_pd(taylor[0]);
+            for(int k = 1; k < 14; ++k) y = _mm512_fmadd_pd(y, r, _mm512_set1_pd(taylor[k]));
+
+            __m512i e = _mm512_sub_epi64(_mm512_castpd_si512(t), _mm512_castpd_si512(_mm512_set1_pd(magic)));
+            e = _mm512_slli_epi64(_mm512_add_epi64(e, _mm512_set1_epi64(1023)), 52);
+
+            return _mm512_maskz_mul_pd(~zero, y, _mm512_castsi512_pd(e));
+        };
+
+#elif defined(__AVX2__) && defined(__FMA__)
+
+        inline __m256d exp(__m256d x) {
+            using namespace exp_const;
+
+            __m256d const zero = _mm256_cmp_pd(x, _mm256_set1_pd(min), _CMP_LT_OQ);
+            x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(min)), _mm256_set1_pd(max));
+
+            __m256d const t = _mm256_fmadd_pd(x, _mm256_set1_pd(log2e), _mm256_set1_pd(magic));
+            __m256d const n = _mm256_sub_pd(t, _mm256_set1_pd(magic));
+            __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(ln2hi), x);
+            r = _mm256_fnmadd_pd(n, _mm256_set1_pd(ln2lo), r);
+
+            __m256d y = _mm256_set1_pd(taylor[0]);
+            for(int k = 1; k < 14; ++k) y = _mm256_fmadd_pd(y, r, _mm256_set1_pd(taylor[k]));
+
+            __m256i e = _mm256_sub_epi64(_mm256_castpd_si256(t), _mm256_castpd_si256(_mm256_set1_pd(magic)));
+            e = _mm256_slli_epi64(_mm256_add_epi64(e, _mm256_set1_epi64x(1023)), 52);
+
+            return _mm256_andnot_pd(zero, _mm256_mul_pd(y, _mm256_castsi256_pd(e)));
+        };
+
+#endif
+
+
+        //dest[i] = exp(time*energies[i] - shift)
+        inline void exp(double* dest, double const* energies, double time, double shift, int n) {
+            int i = 0;
+#if defined(__AVX512F__)
+            for(; i + 8 <= n; i += 8)
+                _mm512_storeu_pd(dest + i, exp(_mm512_sub_pd(_mm512_mul_pd(_mm512_set1_pd(time), _mm512_loadu_pd(energies + i)), _mm512_set1_pd(shift))));
+#elif defined(__AVX2__) && defined(__FMA__)
+            for(; i + 4 <= n; i += 4)
+                _mm256_storeu_pd(dest + i, exp(_mm256_sub_pd(_mm256_mul_pd(_mm256_set1_pd(time), _mm256_loadu_pd(energies + i)), _mm256_set1_pd(shift))));
+#endif
+            for(; i < n; ++i) dest[i] = std::exp(time*energies[i] - shift);
+        };
+
+
+        //Row i of the factors by which the density matrix gets scaled:
+        //factors[j] = (p_i - p_j)/(e_j - e_i), or its expansion around e_i = e_j (symmetric) if |deltaTime*(e_j - e_i)| <= 1.e-7
+        inline void density_factors(double* factors, double const* energies, double const* prop, double ei, double pi, double deltaTime, int n) {
+            int j = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+            __m256d const vei = _mm256_set1_pd(ei), vpi = _mm256_set1_pd(pi), vdt = _mm256_set1_pd(deltaTime);
+            __m256d const half = _mm256_set1_pd(.5), absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL)), eps = _mm256_set1_pd(1.e-7);
+            for(; j + 4 <= n; j += 4) {
+                __m256d const pj = _mm256_loadu_pd(prop + j);
+                __m256d const deltaE = _mm256_sub_pd(_mm256_loadu_pd(energies + j), vei);
+                __m256d const delta = _mm256_mul_pd(vdt, deltaE);
+                __m256d const exact = _mm256_cmp_pd(_mm256_and_pd(delta, absMask), eps, _CMP_GT_OQ);
+                __m256d const approx = _mm256_mul_pd(_mm256_mul_pd(vdt, half), _mm256_add_pd(_mm256_add_pd(vpi, pj), _mm256_mul_pd(_mm256_mul_pd(delta, half), _mm256_sub_pd(pj, vpi))));
+                _mm256_storeu_pd(factors + j, _mm256_blendv_pd(approx, _mm256_div_pd(_mm256_sub_pd(vpi, pj), deltaE), exact));
+            }
+#endif
+            for(; j < n; ++j) {
+                double const deltaE = energies[j] - ei; double const delta = deltaTime*deltaE;
+                factors[j] = std::abs(delta) > 1.e-7 ? (pi - prop[j])/deltaE : deltaTime/2.*(pi + prop[j] + delta/2.*(prop[j] - pi)); //approximation is symmetric
+            }
+        };
+
+
+        //Scales row i of the density matrix by the factors above, factors is scratch of size n. With AVX-512 the compiler vectorises
+        //the plain loop, which is faster than the AVX2 kernel there, so only AVX2 builds use the kernel (c.f. bench/Simd.C).
+        template<typename Value>
+        inline void density_scale(Value* row, double const* energies, double const* prop, double ei, double pi, double deltaTime, int n, double* factors) {
+#if defined(__AVX2__) && defined(__FMA__) && !defined(__AVX512F__)
+            density_factors(factors, energies, prop, ei, pi, deltaTime, n);
+            for(int j = 0; j < n; ++j) row[j] *= factors[j];
+#else
+            for(int j = 0; j < n; ++j) {
+                double const deltaE = energies[j] - ei; double const delta = deltaTime*deltaE;
+                row[j] *= std::abs(delta) > 1.e-7 ? (pi - prop[j])/deltaE : deltaTime/2.*(pi + prop[j] + delta/2.*(prop[j] - pi)); //approximation is symmetric
+            }
+#endif
+        };
+
+    }
+
+}
+
+#endif
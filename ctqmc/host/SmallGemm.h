@@ -0,0 +1,97 @@
+#ifndef CTQMC_HOST_SMALLGEMM_H
+#define CTQMC_HOST_SMALLGEMM_H
+
+#include <cstdint>
+#include <type_traits>
+
+//Matrix products of tiny sectors, where the BLAS call costs more than the arithmetic.
+
+namespace imp {
+
+    namespace small {
+        
+        //dest = diag(prop)*L*R with L of dimension I x K and R of dimension K x J (row major), prop may be null.
+        //With the inner dimension known at compile time the loop over k is unrolled and the one over j vectorised.
+        template<int K, typename Value>
+        void gemm(Value* dest, double const* prop, Value const* L, Value const* R, int I, int J) {
+            for(int i = 0; i < I; ++i) {
+                Value l[K]; for(int k = 0; k < K; ++k) l[k] = prop ? prop[i]*L[i*K + k] : L[i*K + k];
+                
+                Value* d = dest + i*J;
+                for(int j = 0; j < J; ++j) {
+                    Value sum = l[0]*R[j];
+                    for(int k = 1; k < K; ++k) sum += l[k]*R[k*J + j];
+                    d[j] = sum;
+                }
+            }
+        };
+        
+        template<typename Value>
+        void gemm(Value* dest, double const* prop, Value const* L, Value const* R, int I, int K, int J) {
+            for(int i = 0; i < I; ++i) {
+                Value* d = dest + i*J;
+                
+                Value a = prop ? prop[i]*L[i*K] : L[i*K];
+                for(int j = 0; j < J; ++j) d[j] = a*R[j];
+                
+                for(int k = 1; k < K; ++k) {
+                    a = prop ? prop[i]*L[i*K + k] : L[i*K + k]; Value const* r = R + k*J;
+                    for(int j = 0; j < J; ++j) d[j] += a*r[j];
+                }
+            }
+        };
+        
+        
+        //The numbers below are from bench/SmallGemm.C against OpenBLAS, square products (ns per product, small -> BLAS):
+        //
+        //  dim   real, avx512   real, avx2    real, no flags   complex, avx512   complex, no flags
+        //  4     11 -> 16       8.5 -> 16     11 -> 16         27 -> 54          49 -> 57
+        //  5     20 -> 18       17 -> 20      18 -> 19         52 -> 78          95 -> 77
+        //  6     33 -> 19       26 -> 16      24 -> 17         95 -> 70          169 -> 67
+        //
+        //BLAS takes over between 4^3 and 6^3 multiply-adds, whatever the instruction set.
+        int const crossover = 4*5*5;
+        
+        //Square products above dimension 4 go to BLAS, and a larger inner dimension only passes is_small for degenerate shapes (I*J <= 100/K),
+        //so kernels are unrolled up to 4. There they beat the runtime loop (ns per product, dimension 4):
+        //
+        //                 real, avx512   real, avx2    real, no flags   complex, avx2   complex, no flags
+        //  unrolled       12             9.7           11               29              68
+        //  loop           28             24            16               40              54
+        //
+        //Complex products without SIMD flags use the loop.
+        int const unrolled = 4;
+        
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+        bool const unroll_complex = true;
+#else
+        bool const unroll_complex = false;
+#endif
+        
+        inline bool is_small(int I, int K, int J) {
+            return K > 0 && static_cast<std::int64_t>(I)*K*J <= crossover;
+        };
+        
+        template<typename Value>
+        using Kernel = void (*)(Value*, double const*, Value const*, Value const*, int, int);
+        
+        //The kernel templated on the inner dimension 0 < K <= unrolled
+        template<typename Value>
+        Kernel<Value> kernel(int K) {
+            static Kernel<Value> const kernels[unrolled + 1] = {
+                nullptr, &gemm<1, Value>, &gemm<2, Value>, &gemm<3, Value>, &gemm<4, Value>
+            };
+            return kernels[K];
+        };
+        
+        //Dispatches on the inner dimension
+        template<typename Value>
+        void mult(Value* dest, double const* prop, Value const* L, Value const* R, int I, int K, int J) {
+            if(K <= unrolled && (unroll_complex || std::is_same<Value, double>::value)) kernel<Value>(K)(dest, prop, L, R, I, J); else gemm(dest, prop, L, R, I, K, J);
+        };
+        
+    }
+    
+}
+
+#endif
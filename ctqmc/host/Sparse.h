@@ -0,0 +1,64 @@
+#ifndef CTQMC_HOST_SPARSE_H
+#define CTQMC_HOST_SPARSE_H
+
+#include <vector>
+#include <complex>
+
+//Compressed sparse row copy of an operator block, for blocks of the annihilation and creation operators which are mostly zero
+//(e.g. with "trunc dim" or Kanamori interactions in large shells).
+
+namespace imp {
+
+    namespace sparse {
+
+        template<typename Value>
+        struct Csr {
+            Csr() = delete;
+            Csr(Value const* data, int I, int J) : row(I + 1, 0) {
+                for(int i = 0; i < I; ++i) {
+                    for(int j = 0; j < J; ++j)
+                        if(data[i*J + j] != Value(.0)) {
+                            col.push_back(j); val.push_back(data[i*J + j]);
+                        }
+                    row[i + 1] = col.size();
+                }
+            };
+            Csr(Csr const&) = delete;
+            Csr(Csr&&) = delete;
+            Csr& operator=(Csr const&) = delete;
+            Csr& operator=(Csr&&) = delete;
+            ~Csr() = default;
+
+            std::vector<int> row, col;
+            std::vector<Value> val;
+        };
+
+
+        //Number of non-zero entries of the I x J matrix data
+        template<typename Value>
+        std::size_t non_zeros(Value const* data, int I, int J) {
+            std::size_t count = 0;
+            for(int n = 0; n < I*J; ++n) if(data[n] != Value(.0)) ++count;
+            return count;
+        };
+
+
+        //dest = diag(prop)*L*R with L sparse of dimension I x K and R dense of dimension K x J (row major), prop may be null.
+        template<typename Value>
+        void mult(Value* dest, double const* prop, Csr<Value> const& L, Value const* R, int I, int J) {
+            for(int i = 0; i < I; ++i) {
+                Value* d = dest + i*J;
+                for(int j = 0; j < J; ++j) d[j] = .0;
+
+                for(int n = L.row[i]; n < L.row[i + 1]; ++n) {
+                    Value const a = prop ? prop[i]*L.val[n] : L.val[n]; Value const* r = R + L.col[n]*J;
+                    for(int j = 0; j < J; ++j) d[j] += a*r[j];
+                }
+            }
+        };
+
+    }
+
+}
+
+#endif
@@ -6,6 +6,10 @@
 #include <ctime>
 #include <tuple>
 #include <random>
+#include <thread>
+#include <exception>
+#include <future>
+#include <cstdio>
 
 #include "Params.h"
 
@@ -24,132 +28,435 @@
 namespace mc {
 
 
+    //A set of Markov chains which are cycled round-robin on one thread and which share the observables and the Wang-Landau weights
+    //
+    //With "checkpoint" : M the chains, the Wang-Landau weights and the measurements are written every M minutes of the measurement
+    //phase to checkpoint_ID.bin (ID of the first chain), from a copy on a separate thread. With "resume" : true the simulations
+    //continue from these files: the chains skip the thermalisation and run for the remaining measurement steps or time, and the
+    //measurements and eta's are those of the checkpoint. Before each checkpoint the observables store the samples taken since their
+    //last store, and their sampling schedules are saved, such that a resumed simulation continues as the checkpointed one. The chains
+    //are saved by id, including those which are already finished or killed and which are not run again on resume.
     template<typename Mode, typename Value>
-    void montecarlo(jsx::value jParams, jsx::value& jSimulation)
-    {
-        params::complete_impurity<Value>(jParams);
+    struct Simulations {
+        Simulations() = delete;
+        Simulations(jsx::value const& jParams, data::Data<Value>& data, jsx::value& jSimulation) :
+        wangLandau_(jParams, data),
+        thermSteps_(0), measSteps_(0), poolHits_(0), poolMisses_(0), cacheHits_(0), precisionChecks_(0), precisionFallbacks_(0), precisionError_(.0), prunedSectors_(0), reactivatedSectors_(0), droppedWeight_(.0), stream_(0),
+        checkpoint_(60*(jParams.is("checkpoint") ? jParams("checkpoint").int64() : 0)),
+        checkpointName_("checkpoint_" + std::to_string(jSimulation(0)("id").int64()) + ".bin"),
+        next_(std::chrono::steady_clock::now() + std::chrono::seconds(checkpoint_)),
+        configs_(jsx::array_t()),
+        ended_(jsx::object_t()) {
+            obs::setup_obs<Mode>(jParams, data, observables_);
+            
+            bool const resume = jParams.is("resume") && jParams("resume").boolean();
+            
+            jsx::value jCheckpoint;
+            if(resume) {
+                if(jParams.is("restart") && jParams("restart").boolean())
+                    throw std::runtime_error("mc::Simulations: restart and resume can not be combined");
+                
+                jCheckpoint = io::binary::read(checkpointName_);
+                if(jCheckpoint("chains").size() != jSimulation.size())
+                    throw std::runtime_error("mc::Simulations: number of Markov chains does not match " + checkpointName_);
+            }
+            
+            for(std::size_t stream = 0; stream < jSimulation.size(); ++stream) {
+                std::string const id = std::to_string(jSimulation(stream)("id").int64());
+                
+                if(resume && !jCheckpoint("chains").is(id))
+                    throw std::runtime_error("mc::Simulations: Markov chain " + id + " not found in " + checkpointName_);
+                
+                if(resume && (jCheckpoint("chains")(id)("done").boolean() || jCheckpoint("chains")(id)("killed").boolean())) {  // ended before the checkpoint
+                    if(jCheckpoint("chains")(id)("done").boolean()) configs_.array().push_back(jCheckpoint("chains")(id)("config"));
+                    ended_[id] = std::move(jCheckpoint("chains")(id));
+                    continue;
+                }
+                
+                jsx::value& jConfig = resume ? jCheckpoint("chains")(id)("config") : jSimulation(stream)("config");
+                
+                simulations_.emplace_back(
+                std::unique_ptr<imp::itf::Batcher<Value>>(new imp::Batcher<Mode, Value>(8192)),
+                std::unique_ptr<state::State<Value>     >(new state::State<Value>(jParams, data, jConfig, Mode())),
+                std::unique_ptr<mch::MarkovChain<Value> >(new mch::MarkovChain<Value>(jParams, jSimulation(stream)("id").int64(), Mode())),
+                std::unique_ptr<mch::Scheduler          >(resume ? new mch::Scheduler(true, mch::Phase::Initialize, jCheckpoint("chains")(id)("progress").int64()) : new mch::Scheduler(false, mch::Phase::Initialize))
+                );
+                
+                upd::setup_updates<Mode>(jParams, data, *std::get<1>(simulations_.back()), *std::get<2>(simulations_.back()));
+                
+                if(resume) std::get<2>(simulations_.back())->restore(jCheckpoint("chains")(id)("markov chain"));
+                if(resume && jCheckpoint("chains")(id).is("pruning")) std::get<1>(simulations_.back())->pruning().restore(jCheckpoint("chains")(id)("pruning"));
+            }
+            
+            if(resume) {
+                for(std::size_t space = 0; space < cfg::Worm::size(); ++space)
+                    if(observables_[space] != nullptr) observables_[space]->restore(jCheckpoint("observables")(space));
+                
+                wangLandau_.restore(jCheckpoint("wang landau"));
+                meas::resume(jCheckpoint("measurements"), measurements_);
+                thermSteps_ = jCheckpoint("thermalization steps").int64();
+                measSteps_  = jCheckpoint("measurement steps").int64();
+            }
+        };
+        Simulations(Simulations const&) = delete;
+        Simulations(Simulations&&) = delete;
+        Simulations& operator=(Simulations const&) = delete;
+        Simulations& operator=(Simulations&&) = delete;
+        ~Simulations() = default;
         
-        data::Data<Value> data(jParams, Mode());
-        data::setup_data<Mode>(jParams, data);
+        //Returns true if all Markov chains are done. If sync is set, it returns false as soon as a Markov chain is
+        //thermalised while the eta's are not yet fixed, such that they can be fixed for all threads at once.
+        bool run(jsx::value const& jParams, data::Data<Value> const& data, bool sync) {
+            while(simulations_.size()) {
+                if(!(stream_ < simulations_.size())) {
+                    stream_ = 0; if(checkpoint_ && !(std::chrono::steady_clock::now() < next_)) checkpoint(data);
+                }
+                
+                auto* batcher = std::get<0>(simulations_[stream_]).get();
+                
+                if(batcher->is_ready()) {
+                    auto& state       = std::get<1>(simulations_[stream_]);
+                    auto& markovChain = std::get<2>(simulations_[stream_]);
+                    auto& scheduler   = std::get<3>(simulations_[stream_]);
+                    
+                    meas::chain() = markovChain->id();
+                    
+                    try {
+                        switch (scheduler->phase()) {
+                            case mch::Phase::Step:
+                                if(!markovChain->cycle(wangLandau_, data, *state, *batcher)) break;
+                                
+                                if(scheduler->done()) {
+                                    if(scheduler->thermalised())
+                                        scheduler->phase() = mch::Phase::Finalize;
+                                    else
+                                        scheduler.reset(new mch::Scheduler(true, mch::Phase::Thermalised));
+                                    break;
+                                }
+                                
+                                if(scheduler->thermalised()) {
+                                    ++measSteps_;
+                                    
+                                    if(observables_[state->worm().index()]->sample(data, *state, markovChain->id()))
+                                        scheduler->phase() = mch::Phase::Sample;
+                                } else {
+                                    ++thermSteps_;
+                                    
+                                    if(state->pruning().template step<Mode>(state->product(), state->densityMatrix()))
+                                        scheduler->phase() = mch::Phase::Prune;
+                                }
+                                
+                                break;
+                                
+                            case mch::Phase::Sample:
+                                if(!observables_[state->worm().index()]->cycle(data, *state, measurements_, *batcher)) break;
+                                
+                                scheduler->phase() = mch::Phase::Step;
+                                
+                                break;
+                                
+                            case mch::Phase::Prune:  // density matrix and sign for the new active sectors
+                                if(!markovChain->init(data, *state, *batcher)) break;
+                                
+                                scheduler->phase() = mch::Phase::Step;
+                                
+                                break;
+                                
+                            case mch::Phase::Thermalised:
+                                if(!wangLandau_.is_thermalised()) {
+                                    if(sync) return false;
+                                    wangLandau_.thermalised();
+                                }
+                                
+                                if(jParams.is("measurement steps"))
+                                    scheduler.reset(new mch::StepsScheduler(jParams("measurement steps").int64(), true, mch::Phase::Step, scheduler->progress()));
+                                else
+                                    scheduler.reset(new mch::TimeScheduler(jParams("measurement time").int64(), true, mch::Phase::Step, scheduler->progress()));
+                                
+                                break;
+                                
+                            case mch::Phase::Finalize:
+                                configs_.array().push_back(state->json());
+                                
+                                ended_[std::to_string(markovChain->id())] = jsx::object_t{
+                                    {"done",   true},
+                                    {"killed", false},
+                                    {"config", configs_.array().back()}
+                                };
+                                
+                                poolHits_   += state->product().memory().hits();
+                                poolMisses_ += state->product().memory().misses();
+                                cacheHits_  += state->product().cacheHits();
+                                
+                                batcher->precision(precisionChecks_, precisionFallbacks_, precisionError_);
+                                
+                                prunedSectors_      += state->pruning().pruned();
+                                reactivatedSectors_ += state->pruning().reactivated();
+                                droppedWeight_      += state->pruning().dropped();
+                                
+                                simulations_.erase(simulations_.begin() + stream_);
+                                batcher = nullptr;
+                                
+                                break;
+                                
+                            case mch::Phase::Initialize:
+                                if(!markovChain->init(data, *state, *batcher)) break;
+                                
+                                if(scheduler->thermalised())  // resumed from a checkpoint
+                                    scheduler.reset(new mch::Scheduler(true, mch::Phase::Thermalised, scheduler->progress()));
+                                else if(jParams.is("thermalisation steps"))
+                                    scheduler.reset(new mch::StepsScheduler(jParams("thermalisation steps").int64(), false, mch::Phase::Step));
+                                else
+                                    scheduler.reset(new mch::TimeScheduler(jParams("thermalisation time").int64(), false, mch::Phase::Step));
+                                
+                                break;
+                        }
+                        
+                        if(batcher != nullptr) batcher->launch();
+                    }
+                    
+                    catch(ut::out_of_memory error) {
+                        if(std::get<3>(simulations_[stream_])->phase() == mch::Phase::Sample)
+                            throw std::runtime_error("MC: Fatal error, out of memory while sampling");
+                        
+                        std::cout << "MC: Markov Chain gets killed." << std::endl;
+                        
+                        ended_[std::to_string(std::get<2>(simulations_[stream_])->id())] = jsx::object_t{
+                            {"done",   false},
+                            {"killed", true},
+                            {"config", std::get<1>(simulations_[stream_])->json()}
+                        };
+                        
+                        simulations_.erase(simulations_.begin() + stream_);
+                        
+                        if(!simulations_.size())
+                            throw std::runtime_error("MC: all Markov Chain killed !");
+                    }
+                }
+                ++stream_;
+            }
+            
+            return true;
+        };
+        
+        void finalize(data::Data<Value> const& data) {
+            if(writer_.valid()) writer_.get();
+            
+            for(std::size_t space = 0; space < cfg::Worm::size(); ++space)
+                if(observables_[space] != nullptr)
+                    observables_[space]->finalize(data, measurements_);
+        };
+        
+        //Only between two steps of all Markov chains in the measurement phase, otherwise tried again after the next round
+        void checkpoint(data::Data<Value> const& data) {
+            for(auto const& simulation : simulations_)
+                if(!(std::get<0>(simulation)->is_ready() && std::get<3>(simulation)->thermalised() && std::get<3>(simulation)->phase() == mch::Phase::Step)) return;
+            
+            meas::chain() = -1;  // the flushed stores are shorter than the others and are not binned
+            
+            jsx::value jObservables = jsx::array_t(cfg::Worm::size());
+            for(std::size_t space = 0; space < cfg::Worm::size(); ++space)
+                if(observables_[space] != nullptr) {
+                    observables_[space]->flush(data, measurements_);
+                    jObservables(space) = observables_[space]->json();
+                } else
+                    jObservables(space) = jsx::null_t();
+            
+            jsx::value jChains = ended_;
+            for(auto const& simulation : simulations_)
+                jChains[std::to_string(std::get<2>(simulation)->id())] = jsx::object_t{
+                    {"done",         false},
+                    {"killed",       false},
+                    {"config",       std::get<1>(simulation)->json()},
+                    {"markov chain", std::get<2>(simulation)->json()},
+                    {"pruning",      std::get<1>(simulation)->pruning().json()},
+                    {"progress",     std::get<3>(simulation)->progress()}
+                };
+            
+            jsx::value jCheckpoint = jsx::object_t{
+                {"chains",               std::move(jChains)},
+                {"observables",          std::move(jObservables)},
+                {"wang landau",          wangLandau_.json()},
+                {"measurements",         meas::snapshot(measurements_)},
+                {"thermalization steps", thermSteps_},
+                {"measurement steps",    measSteps_}
+            };
+            
+            if(writer_.valid()) writer_.get();  // one checkpoint at a time
+            
+            writer_ = std::async(std::launch::async, [](std::string const& name, jsx::value const& jCheckpoint) {
+                io::binary::write(jCheckpoint, name + ".tmp");
+                if(std::rename((name + ".tmp").c_str(), name.c_str())) throw std::runtime_error("mc::Simulations: can not write " + name);
+            }, checkpointName_, std::move(jCheckpoint));
+            
+            next_ = std::chrono::steady_clock::now() + std::chrono::seconds(checkpoint_);
+        };
         
-        obs::Observables<Value> observables;
-        obs::setup_obs<Mode>(jParams, data, observables);
+        obs::Observables<Value> const& observables() const { return observables_;};
+        mch::WangLandau<Value>& wangLandau() { return wangLandau_;};
+        jsx::value& measurements() { return measurements_;};
+        jsx::value& configs() { return configs_;};
+        std::int64_t thermSteps() const { return thermSteps_;};
+        std::int64_t measSteps() const { return measSteps_;};
+        std::int64_t poolHits() const { return poolHits_;};
+        std::int64_t poolMisses() const { return poolMisses_;};
+        std::int64_t cacheHits() const { return cacheHits_;};
+        std::int64_t precisionChecks() const { return precisionChecks_;};
+        std::int64_t precisionFallbacks() const { return precisionFallbacks_;};
+        double precisionError() const { return precisionError_;};
+        std::int64_t prunedSectors() const { return prunedSectors_;};
+        std::int64_t reactivatedSectors() const { return reactivatedSectors_;};
+        double droppedWeight() const { return droppedWeight_;};
         
-        mch::WangLandau<Value> wangLandau(jParams, data);
+    private:
+        obs::Observables<Value> observables_;
+        mch::WangLandau<Value> wangLandau_;
         
         std::vector<std::tuple<
         std::unique_ptr<imp::itf::Batcher<Value>>, //0
         std::unique_ptr<state::State<Value>     >, //1
         std::unique_ptr<mch::MarkovChain<Value> >, //2
         std::unique_ptr<mch::Scheduler          >  //3
-        >> simulations;
+        >> simulations_;
+        
+        std::int64_t thermSteps_, measSteps_;
+        std::int64_t poolHits_, poolMisses_, cacheHits_;
+        std::int64_t precisionChecks_, precisionFallbacks_;
+        double precisionError_;
+        std::int64_t prunedSectors_, reactivatedSectors_;
+        double droppedWeight_;
+        std::size_t stream_;
+        
+        std::int64_t const checkpoint_;  // in seconds
+        std::string const checkpointName_;
+        std::chrono::steady_clock::time_point next_;
+        std::future<void> writer_;
         
-        for(int stream = 0; stream < jSimulation.size(); ++stream) {
+        jsx::value measurements_;
+        jsx::value configs_;
+        jsx::value ended_;  // finished and killed Markov chains by id, c.f. checkpoints
+    };
+    
+    
+    //Runs each group of Markov chains on its own thread, all sharing the same (read-only) data. Threads are joined
+    //once all chains are thermalised in order to fix the eta's, which requires mpi communication.
+    template<typename Mode, typename Value>
+    void run_threads(jsx::value const& jParams, data::Data<Value> const& data, std::vector<std::unique_ptr<Simulations<Mode, Value>>>& threads)
+    {
+        std::vector<std::exception_ptr> errors(threads.size());
+        
+        auto run = [&](bool sync) {
+            std::vector<std::thread> workers;
             
-            simulations.emplace_back(
-            std::unique_ptr<imp::itf::Batcher<Value>>(new imp::Batcher<Mode, Value>(8192)),
-            std::unique_ptr<state::State<Value>     >(new state::State<Value>(jParams, data, jSimulation(stream)("config"), Mode())),
-            std::unique_ptr<mch::MarkovChain<Value> >(new mch::MarkovChain<Value>(jParams, jSimulation(stream)("id").int64(), Mode())),
-            std::unique_ptr<mch::Scheduler          >(new mch::Scheduler(false, mch::Phase::Initialize))
-            );
-
-            upd::setup_updates<Mode>(jParams, data, *std::get<1>(simulations.back()), *std::get<2>(simulations.back()));
-        }
-
+            for(std::size_t t = 0; t < threads.size(); ++t)
+                workers.emplace_back([&, t]() {
+                    try {
+                        threads[t]->run(jParams, data, sync);
+                    } catch(...) {
+                        errors[t] = std::current_exception();
+                    }
+                });
+            
+            for(auto& worker : workers) worker.join();
+            
+            for(auto& error : errors)
+                if(error) std::rethrow_exception(error);
+        };
+        
+        run(true);
+        
+        std::vector<mch::WangLandau<Value>*> wangLandaus;
+        for(auto& thread : threads) wangLandaus.push_back(&thread->wangLandau());
+        mch::WangLandau<Value>::thermalised(wangLandaus);
+        
+        run(false);
+    }
+    
+    
+    template<typename Mode, typename Value>
+    void montecarlo(jsx::value jParams, jsx::value& jSimulation)
+    {
+        params::complete_impurity<Value>(jParams);
+        
+        data::Data<Value> data(jParams, Mode());
+        data::setup_data<Mode>(jParams, data);
+        
+        std::int64_t const numberOfThreads = jParams.is("threads") ? jParams("threads").int64() : 1;
+        
+        std::vector<std::unique_ptr<Simulations<Mode, Value>>> threads;
+        
+        if(numberOfThreads > 1) {
+            if(static_cast<std::int64_t>(jSimulation.size()) != numberOfThreads)
+                throw std::runtime_error("mc::montecarlo: number of Markov chains does not match number of threads");
+            
+            for(std::size_t stream = 0; stream < jSimulation.size(); ++stream) {
+                jsx::value jStream = jsx::array_t{ jSimulation(stream) };
+                threads.emplace_back(new Simulations<Mode, Value>(jParams, data, jStream));
+            }
+        } else
+            threads.emplace_back(new Simulations<Mode, Value>(jParams, data, jSimulation));
+        
+        auto& simulations = *threads.front();
+        
+        meas::restart(jParams, simulations.measurements());
+        
+        meas::binning() = jParams("binning").boolean();
+        
+        if(threads.size() > 1)
+            run_threads(jParams, data, threads);
+        else
+            simulations.run(jParams, data, false);
+        
         jSimulation["configs"] = jsx::array_t();
         
-        meas::restart(jParams,jSimulation["measurements"]);
+        std::int64_t thermSteps = 0, measSteps = 0, poolHits = 0, poolMisses = 0, cacheHits = 0, precisionChecks = 0, precisionFallbacks = 0;
+        double precisionError = .0;
+        std::int64_t prunedSectors = 0, reactivatedSectors = 0;
+        double droppedWeight = .0;
+        std::vector<std::int64_t> samples(cfg::Worm::size(), 0), skipped(cfg::Worm::size(), 0), adaptive(cfg::Worm::size(), 0);
+        std::vector<double> tau(cfg::Worm::size(), .0);
         
-        std::int64_t thermSteps = 0, measSteps = 0, stream = 0;
+        meas::chain() = -1;  // the last stores of the observables are incomplete, and on this thread not attributable to a Markov chain
         
-        while(simulations.size()) {
-            auto* batcher = std::get<0>(simulations[stream]).get();
-
-            if(batcher->is_ready()) {
-                auto& state       = std::get<1>(simulations[stream]);
-                auto& markovChain = std::get<2>(simulations[stream]);
-                auto& scheduler   = std::get<3>(simulations[stream]);
-
-                try {
-                    switch (scheduler->phase()) {
-                        case mch::Phase::Step:
-                            if(!markovChain->cycle(wangLandau, data, *state, *batcher)) break;
-                                         
-                            if(scheduler->done()) {
-                                if(scheduler->thermalised()) {
-                                    scheduler->phase() = mch::Phase::Finalize;
-                                } else {
-                                    if(jParams.is("measurement steps"))
-                                        scheduler.reset(new mch::StepsScheduler(jParams("measurement steps").int64(), true, mch::Phase::Step));
-                                    else
-                                        scheduler.reset(new mch::TimeScheduler(jParams("measurement time").int64(), true, mch::Phase::Step));
-                                    wangLandau.thermalised();
-                                }
-                                break;
-                            }
-                            
-                            if(scheduler->thermalised()) {
-                                ++measSteps;
-                                
-                                if(observables[state->worm().index()]->sample(data, *state))
-                                    scheduler->phase() = mch::Phase::Sample;
-                            } else
-                                ++thermSteps;
-
-                            break;
-                            
-                        case mch::Phase::Sample:
-                            if(!observables[state->worm().index()]->cycle(data, *state, jSimulation["measurements"], *batcher)) break;
-                            
-                            scheduler->phase() = mch::Phase::Step;
-                            
-                            break;
-                        
-                        case mch::Phase::Finalize:
-                            jSimulation["configs"].array().push_back(state->json());
-
-                            simulations.erase(simulations.begin() + stream);
-                            batcher = nullptr;
-
-                            break;
-                            
-                        case mch::Phase::Initialize:
-                            if(!markovChain->init(data, *state, *batcher)) break;
-
-                            if(jParams.is("thermalisation steps"))
-                                scheduler.reset(new mch::StepsScheduler(jParams("thermalisation steps").int64(), false, mch::Phase::Step));
-                            else
-                                scheduler.reset(new mch::TimeScheduler(jParams("thermalisation time").int64(), false, mch::Phase::Step));
-                            
-                            break;
-                    }
-
-                    if(batcher != nullptr) batcher->launch();
-                }
+        for(auto& thread : threads) {
+            for(std::size_t space = 0; space < cfg::Worm::size(); ++space) {
+                auto const& observables = thread->observables()[space];
+                if(observables == nullptr || !observables->adaptive()) continue;
                 
-                catch(ut::out_of_memory error) {
-                    if(std::get<3>(simulations[stream])->phase() == mch::Phase::Sample)
-                        throw std::runtime_error("MC: Fatal error, out of memory while sampling");
-                    
-                    std::cout << "MC: Markov Chain gets killed." << std::endl;
-
-                    simulations.erase(simulations.begin() + stream);
-                    
-                    if(!simulations.size())
-                        throw std::runtime_error("MC: all Markov Chain killed !");
-                }
+                samples[space] += observables->samples(); skipped[space] += observables->skipped();
+                tau[space] += observables->tau(); adaptive[space] += observables->chains();
+            }
+            
+            thread->finalize(data);
+            
+            if(thread != threads.front()) {
+                meas::merge(simulations.measurements(), thread->measurements());
+                simulations.wangLandau().add(thread->wangLandau());
+                thread->measurements() = jsx::empty_t();
             }
-            if(!(++stream < simulations.size())) stream = 0;
+            
+            for(auto& config : thread->configs().array())
+                jSimulation["configs"].array().push_back(std::move(config));
+            
+            thermSteps += thread->thermSteps();
+            measSteps  += thread->measSteps();
+            poolHits   += thread->poolHits();
+            poolMisses += thread->poolMisses();
+            cacheHits  += thread->cacheHits();
+            precisionChecks    += thread->precisionChecks();
+            precisionFallbacks += thread->precisionFallbacks();
+            precisionError      = std::max(precisionError, thread->precisionError());
+            prunedSectors      += thread->prunedSectors();
+            reactivatedSectors += thread->reactivatedSectors();
+            droppedWeight      += thread->droppedWeight();
         }
         
-        for(std::size_t space = 0; space < cfg::Worm::size(); ++space)
-            if(observables[space] != nullptr)
-                observables[space]->finalize(data, jSimulation["measurements"]);
+        jSimulation["measurements"] = std::move(simulations.measurements());
+        
+        simulations.wangLandau().finalize(jSimulation["measurements"]);
         
-        wangLandau.finalize(jSimulation["measurements"]);
-
         
-        jSimulation["etas"] = wangLandau.etas();
+        jSimulation["etas"] = simulations.wangLandau().etas();
         
 
         std::int64_t numberOfMarkovChains = jSimulation["configs"].size();
@@ -157,13 +464,66 @@ namespace mc {
         mpi::reduce<mpi::op::sum>(numberOfMarkovChains, mpi::master);
         mpi::reduce<mpi::op::sum>(thermSteps,           mpi::master);
         mpi::reduce<mpi::op::sum>(measSteps,            mpi::master);
+        mpi::reduce<mpi::op::sum>(poolHits,             mpi::master);
+        mpi::reduce<mpi::op::sum>(poolMisses,           mpi::master);
+        mpi::reduce<mpi::op::sum>(cacheHits,            mpi::master);
+        mpi::reduce<mpi::op::sum>(samples,              mpi::master);
+        mpi::reduce<mpi::op::sum>(skipped,              mpi::master);
+        mpi::reduce<mpi::op::sum>(adaptive,             mpi::master);
+        mpi::reduce<mpi::op::sum>(tau,                  mpi::master);
+        mpi::reduce<mpi::op::sum>(precisionChecks,      mpi::master);
+        mpi::reduce<mpi::op::sum>(precisionFallbacks,   mpi::master);
+        mpi::reduce<mpi::op::max>(precisionError,       mpi::master);
+        mpi::reduce<mpi::op::sum>(prunedSectors,        mpi::master);
+        mpi::reduce<mpi::op::sum>(reactivatedSectors,   mpi::master);
+        mpi::reduce<mpi::op::sum>(droppedWeight,        mpi::master);
 
         jSimulation["info"] = jsx::object_t{
             { "number of mpi processes", mpi::number_of_workers() },
+            { "number of threads",       numberOfThreads },
             { "number of markov chains", numberOfMarkovChains },
             { "thermalization steps",    thermSteps },
-            { "measurement steps",       measSteps }
+            { "measurement steps",       measSteps },
+            { "pool hits",               poolHits },
+            { "pool misses",             poolMisses }
         };
+        
+        //Propagators found in the cache instead of being computed (c.f. impurity/Pool.h)
+        if(jParams.is("propagator cache") && jParams("propagator cache").int64())
+            jSimulation["info"]["propagator cache hits"] = cacheHits;
+        
+        //Samples taken by all observables of a worm space, the samples saved with respect to the fixed sweeps and the autocorrelation time (in steps) averaged over the Markov chains
+        if(jParams.is("adaptive sweep")) {
+            auto const names = cfg::Worm::get_names();
+            
+            jsx::value jAdaptive = jsx::object_t();
+            for(std::size_t space = 0; space < cfg::Worm::size(); ++space)
+                if(jParams.is(names[space]))
+                    jAdaptive[names[space]] = jsx::object_t{
+                        { "samples", samples[space] },
+                        { "skipped", skipped[space] },
+                        { "tau",     adaptive[space] ? tau[space]/adaptive[space] : -1. }
+                    };
+            
+            jSimulation["info"]["adaptive sweep"] = std::move(jAdaptive);
+        }
+        
+        //Double precision recomputations of single precision products, the largest relative difference found and the number of Markov chains which went back to double
+        if(jParams("precision").string() == "mixed")
+            jSimulation["info"]["mixed precision"] = jsx::object_t{
+                { "checks",    precisionChecks },
+                { "max error", precisionError },
+                { "fallbacks", precisionFallbacks }
+            };
+        
+        //Sectors dropped in the measurement phase, their probability in the last block of the thermalisation and sectors reactivated
+        //during the thermalisation, per Markov chain
+        if(jParams.is("prune sectors"))
+            jSimulation["info"]["sector pruning"] = jsx::object_t{
+                { "pruned",         numberOfMarkovChains ? prunedSectors/static_cast<double>(numberOfMarkovChains) : .0 },
+                { "dropped weight", numberOfMarkovChains ? droppedWeight/static_cast<double>(numberOfMarkovChains) : .0 },
+                { "reactivated",    numberOfMarkovChains ? reactivatedSectors/static_cast<double>(numberOfMarkovChains) : .0 }
+            };
 
     }
     
@@ -172,10 +532,14 @@ namespace mc {
     
     template<typename Value>
     void statistics(jsx::value jParams, jsx::value& jSimulation) {
+        std::size_t const memory = (jParams.is("reduce memory") ? jParams("reduce memory").int64() : 64) << 20;  // in megabytes
+        
+        if(jParams("binning").boolean()) jSimulation["binning"] = meas::binning(jSimulation("measurements"), jSimulation("etas"), memory);
+        
         if(mpi::number_of_workers() > 1 && jParams("error").string() != "none") {
             jsx::value jMeasurements = std::move(jSimulation("measurements"));
             
-            meas::reduce(jSimulation("measurements"), jMeasurements, jSimulation("etas"), meas::All(), true);
+            meas::reduce(jSimulation("measurements"), jMeasurements, jSimulation("etas"), meas::All(), true, memory);
 
             if(jParams("error").string() == "parallel") {
                 
@@ -188,23 +552,23 @@ namespace mc {
                 jParams["serial evalsim"] = true;
                 jParams["limited post-processing"] = !jParams("all errors").boolean();
                 
-                meas::reduce(jMeasurements, jMeasurements, jSimulation("etas"), meas::Jackknife(), false);
+                meas::reduce(jMeasurements, jMeasurements, jSimulation("etas"), meas::Jackknife(), false, memory);
                 jSimulation["error"] = evalsim::evalsim<Value>(jParams, jMeasurements);
                 meas::error(jSimulation("error"), meas::Jackknife());
                 
             } else if(jParams("error").string() == "serial") {
                 
-                meas::reduce(jMeasurements, jMeasurements, jSimulation("etas"), meas::Jackknife(), true);
+                meas::reduce(jMeasurements, jMeasurements, jSimulation("etas"), meas::Jackknife(), true, memory);
                 jSimulation["resample"] = std::move(jMeasurements);
-                io::to_tagged_json(jSimulation("resample"));
+                if(!meas::binary(jParams)) io::to_tagged_json(jSimulation("resample"));
                 
             } else
                 throw std::runtime_error("mc::statistics: invalid error option " + jParams("error").string());
             
         } else
-            meas::reduce(jSimulation("measurements"), jSimulation("measurements"), jSimulation("etas"), meas::All(), true);
+            meas::reduce(jSimulation("measurements"), jSimulation("measurements"), jSimulation("etas"), meas::All(), true, memory);
         
-        io::to_tagged_json(jSimulation("measurements"));
+        if(!meas::binary(jParams)) io::to_tagged_json(jSimulation("measurements"));
     }
 }
 
@@ -14,10 +14,12 @@ namespace params {
     void complete_impurity(jsx::value& jParams)
     {
         opt::complete_hloc<Value>(jParams);
-        jParams("hloc") = ga::construct_hloc<Value>(jParams("hloc"));
+        std::size_t const numberOfThreads = jParams.is("threads") ? jParams("threads").int64() : 1;
+        
+        jParams("hloc") = ga::construct_hloc<Value>(jParams("hloc"), true, numberOfThreads, jParams.is("hloc cache") ? jParams("hloc cache").string() : "");
         mpi::write(jParams("hloc"), "hloc.json");
         
-        jParams["operators"] = ga::construct_annihilation_operators<Value>(jParams("hloc"));
+        jParams["operators"] = ga::construct_annihilation_operators<Value>(jParams("hloc"), numberOfThreads);
         
         jParams("hybridisation")("functions") = mpi::read(jParams("hybridisation")("functions").string());
         
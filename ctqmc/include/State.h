@@ -8,6 +8,7 @@
 #include "impurity/Product.h"
 #include "impurity/Dynamic.h"
 #include "impurity/DensityMatrix.h"
+#include "impurity/Pruning.h"
 #include "impurity/Fact.h"
 #include "bath/Bath.h"
 #include "config/Expansion.h"
@@ -39,6 +40,7 @@ namespace state {
         worm_( safe_to_load_from_json_ and jConfig.is("worm") ? jConfig("worm") : jsx::object_t{{"name", "partition"}, {"entry", jsx::null_t()}}),
         product_(new imp::Product<Mode, Value>(jParams, data.eig(), data.ide(), data.ops())),
         densityMatrix_(new imp::DensityMatrix<Mode, Value>()),
+        pruning_(jParams, data.eig()),
         baths_(data.hyb().blocks().size()),
         dyn_(data.dyn() != nullptr ? new imp::Dynamic(*data.dyn()) : new imp::itf::Dynamic()) {
             int index = 0;
@@ -109,6 +111,9 @@ namespace state {
         imp::Fact<Value>& fact() {
             return fact_;
         };
+        imp::Pruning& pruning() {
+            return pruning_;
+        };
         
         
         int signTimeOrder() const {
@@ -135,6 +140,9 @@ namespace state {
         imp::Fact<Value> const& fact() const {
             return fact_;
         };
+        imp::Pruning const& pruning() const {
+            return pruning_;
+        };
         
         
         Value sign() const {
@@ -143,10 +151,20 @@ namespace state {
             return sign;
         };
         
-        void clean(data::Data<Value> const& data) {
+        double clean(data::Data<Value> const& data) {
+            double drift = .0;
             dyn().clean();
             for(auto& bath : baths())
-                bath.clean(data.hyb());
+                drift = std::max(drift, bath.clean(data.hyb()));
+            return drift;
+        };
+        
+        //largest residual of the fast updated inverse hybridisation matrices, for the column n modulo their size (c.f. bath::Bath::residual)
+        double residual(data::Data<Value> const& data, std::int64_t n) const {
+            double residual = .0;
+            for(auto const& bath : baths())
+                if(bath.opsL().size()) residual = std::max(residual, bath.residual(data.hyb(), n % bath.opsL().size()));
+            return residual;
         };
         
         jsx::value json() const {
@@ -164,6 +182,7 @@ namespace state {
         
         std::unique_ptr<imp::itf::Product<Value>> product_;
         std::unique_ptr<imp::itf::DensityMatrix<Value>> densityMatrix_;
+        imp::Pruning pruning_;
         std::vector<bath::Bath<Value>> baths_;
         std::unique_ptr<imp::itf::Dynamic> dyn_;
         imp::Fact<Value> fact_;
@@ -201,7 +220,7 @@ namespace state {
         imp::DensityMatrix<Mode, Value> densityMatrix_;
         
         ut::Flag prepare(data::Data<Value> const& data, State<Value>& state) {
-            densityMatrix_ = imp::DensityMatrix<Mode, Value>(state.product(), data.eig());
+            densityMatrix_ = imp::DensityMatrix<Mode, Value>(state.product(), data.eig(), state.pruning().sectors());
             if(ut::Flag::Pending != densityMatrix_.surviving(data.eig()))
                 throw std::runtime_error("state::Init: initial trace is zero");
             return ut::Flag::Pending;
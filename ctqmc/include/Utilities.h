@@ -11,6 +11,8 @@
 #include <random>
 #include <limits>
 #include <utility>
+#include <string>
+#include <sstream>
 #include <stdexcept>
 
 
@@ -39,6 +41,8 @@ namespace ut {
     struct RandomNumberGenerator {
         RandomNumberGenerator(E const& eng, D const& distr) : eng_(eng), distr_(distr) {};
         typename D::result_type operator()() { return distr_(eng_);};
+        std::string state() const { std::ostringstream stream; stream << eng_ << " " << distr_; return stream.str();};
+        void state(std::string const& arg) { std::istringstream stream(arg); stream >> eng_ >> distr_;};
     private:
         E eng_; D distr_;
     };
@@ -9,6 +9,7 @@
 #include <algorithm>
 
 #include "Hyb.h"
+#include "Index.h"
 #include "../Utilities.h"
 #include "../../../include/BlasLapack.h"
 
@@ -46,10 +47,11 @@ namespace bath {
     template<typename, typename> struct Update;
     
     
+    //The leading dimension ld() can be larger than dim(), such that the inserts and erases are done in place
     template<typename Value>
     struct Matrix {
         Matrix() = delete;
-        explicit Matrix(int dim) : dim_(dim), data_(dim_*dim_) {};
+        explicit Matrix(int dim) : dim_(dim), ld_(dim), data_(ld_*ld_) {};
         Matrix(Matrix const&) = default;
         Matrix(Matrix&&) = default;
         Matrix& operator=(Matrix const&) = default;
@@ -57,15 +59,28 @@ namespace bath {
         ~Matrix() = default;
         
         int dim() const { return dim_;};
-        Value& at(int i, int j) { return data_[i + dim_*j];};
-        Value const& at(int i, int j) const { return data_[i + dim_*j];};
+        int ld() const { return ld_;};
+        Value& at(int i, int j) { return data_[i + ld_*j];};
+        Value const& at(int i, int j) const { return data_[i + ld_*j];};
         Value* data() { return data_.data();};
         Value const* data() const { return data_.data();};
-        Value* data(int i, int j) { return data_.data() + i + j*dim_;};
-        Value const* data(int i, int j) const { return data_.data() + i + j*dim_;};
+        Value* data(int i, int j) { return data_.data() + i + j*ld_;};
+        Value const* data(int i, int j) const { return data_.data() + i + j*ld_;};
+        
+        //keeps the upper left block, the capacity grows geometrically
+        void resize(int dim) {
+            if(dim > ld_) {
+                int const ld = std::max(dim, 2*ld_); std::vector<Value> data(ld*ld);
+                for(int j = 0; j < std::min(dim_, dim); ++j)
+                    std::copy(this->data(0, j), this->data(0, j) + std::min(dim_, dim), data.data() + j*ld);
+                ld_ = ld; data_.swap(data);
+            }
+            dim_ = dim;
+        };
         
     private:
         int dim_;
+        int ld_;
         std::vector<Value> data_;
     };
     
@@ -86,8 +101,8 @@ namespace bath {
 /*
  std::vector<Operator<Value>> opsL_;
  std::vector<Operator<Value>> opsR_;
- std::map<ut::KeyType, int> posL_;
- std::map<ut::KeyType, int> posR_;
+ Index posL_;
+ Index posR_;
  */
     
 
@@ -136,21 +151,21 @@ namespace bath {
         
         int eraseL(ut::KeyType key) {
             int sign = 1;
-            auto const itL = posL_.find(key); auto const posL = itL->second;
+            auto const posL = posL_.find(key);
             if(posL != opsL_.size() - 1)
                 sign*=-1;
             posL_[opsL_.back().key()] = posL; opsL_[posL] = opsL_.back();
-            posL_.erase(itL); opsL_.pop_back();
+            posL_.erase(key); opsL_.pop_back();
             return sign;
         };
         
         int eraseR(ut::KeyType key) {
             int sign = 1;
-            auto const itR = posR_.find(key); auto const posR = itR->second;
+            auto const posR = posR_.find(key);
             if(posR != opsR_.size() - 1)
                 sign*=-1;
             posR_[opsR_.back().key()] = posR; opsR_[posR] = opsR_.back();
-            posR_.erase(itR); opsR_.pop_back();
+            posR_.erase(key); opsR_.pop_back();
             return sign;
         };
 		
@@ -159,32 +174,64 @@ namespace bath {
         
         Value sign() const { return det_/std::abs(det_);};
 	
-        void clean(Hyb<Value> const& hyb) {
+        //returns the largest deviation of the fast updated B from the recomputed one, relative to the largest entry
+        double clean(Hyb<Value> const& hyb) {
             if(opsL_.size() != opsR_.size())
                 throw std::runtime_error("bath::bath::clean: invalid configuration.");
             
-            int const N = opsL_.size();
+            int const N = opsL_.size(); double drift = .0;
             
-            det_ = 1.;  if(N != B_.dim()) B_ = Matrix<Value>(N);  
+            det_ = 1.;
 
 			if(N) {
-				Matrix<Value> toInvert(N);
+				Matrix<Value> toInvert(N), inverse(N);
 
-				for(int j = 0; j < N; ++j) 					
-					for(int i = 0; i < N; ++i) 
-						toInvert.at(i, j) = hyb(opsL_[i].flavor(), opsR_[j].flavor(), opsL_[i].key() - opsR_[j].key());
+				for(int j = 0; j < N; ++j)
+					hyb.column(opsL_, opsR_[j].flavor(), opsR_[j].key(), toInvert.data(0, j));
 				
-                std::fill(B_.data(), B_.data() + N*N, .0);
-                for(int i = 0; i < N; ++i) B_.at(i, i) = 1.;
+                for(int i = 0; i < N; ++i) inverse.at(i, i) = 1.;
 				
 				int* ipiv = new int[N]; int info;
-				gesv(&N, &N, toInvert.data(), &N, ipiv, B_.data(), &N, &info);
+				gesv(&N, &N, toInvert.data(), &N, ipiv, inverse.data(), &N, &info);
 				for(int i = 0; i < N; ++i) 
 					det_ *= (ipiv[i] != i + 1 ? -toInvert.at(i, i) : toInvert.at(i, i));
 				delete[] ipiv;
-			}
+                
+                if(N == B_.dim()) {
+                    double max = .0;
+                    for(int j = 0; j < N; ++j)
+                        for(int i = 0; i < N; ++i) {
+                            drift = std::max(drift, std::abs(B_.at(i, j) - inverse.at(i, j)));
+                            max = std::max(max, std::abs(inverse.at(i, j)));
+                        }
+                    if(max > .0) drift /= max;
+                }
+                
+                B_.resize(N);
+                for(int j = 0; j < N; ++j)
+                    std::copy(inverse.data(0, j), inverse.data(0, j) + N, B_.data(0, j));
+			} else
+                B_.resize(0);
+            
+            return drift;
 		}
         
+        //returns max_i |(B*D)_ij - delta_ij| for the column j of the hybridisation matrix D, i.e. the drift of the fast updates in O(N^2)
+        double residual(Hyb<Value> const& hyb, int j) const {
+            int const N = opsL_.size(); if(N == 0 || N != B_.dim()) return .0;
+            
+            static thread_local std::vector<Value> column, result;  // scratch, one per thread of Markov chains
+            column.resize(N); result.resize(N);
+            hyb.column(opsL_, opsR_[j].flavor(), opsR_[j].key(), column.data());
+            
+            char const transNo = 'n'; int const inc = 1; int const ld = B_.ld(); Value const one = 1., zero = .0;
+            gemv(&transNo, &N, &N, &one, B_.data(), &ld, column.data(), &inc, &zero, result.data(), &inc);
+            
+            double residual = .0; result[j] -= 1.;
+            for(int i = 0; i < N; ++i) residual = std::max(residual, std::abs(result[i]));
+            return residual;
+        };
+        
         template<typename Type>
         void add(Hyb<Value> const& hyb, Type type) {
             if(update_.get() == nullptr)
@@ -219,8 +266,8 @@ namespace bath {
         
         std::vector<Operator<Value>> opsL_;
         std::vector<Operator<Value>> opsR_;
-        std::map<ut::KeyType, int> posL_;
-        std::map<ut::KeyType, int> posR_;
+        Index posL_;
+        Index posR_;
         
         std::unique_ptr<itf::Update<Value>> update_;
         
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <sstream>
 
+#include "Interpolate.h"
 #include "../Utilities.h"
 #include "../../../include/atomic/Generate.h"
 
@@ -66,7 +67,7 @@ namespace bath {
         Simple() = delete;
         Simple(jsx::value const& jParams, std::vector<std::complex<double>> const& hyb, std::vector<std::complex<double>> hybTransp) :
         I_(std::max(static_cast<int>((jParams.is("hybridisation factor") ? jParams("hybridisation factor").real64() : 4.)*hyb.size()), 1)),
-        fact_(I_/static_cast<double>(ut::KeyMax)),
+        fact_(I_/static_cast<double>(ut::KeyMax >> interpolate::shift)),
         data_(I_ + 2) {
             Fit<Value> fit(ut::beta(), hyb, hybTransp);
             
@@ -97,10 +98,12 @@ namespace bath {
         Simple& operator=(Simple&&) = delete;
         
         Value get(ut::KeyType key) const {
-            double it = fact_*key; int i0 = static_cast<int>(it);
-            return (1. - (it - i0))*data_[i0] + (it - i0)*data_[i0 + 1];
+            return interpolate::get(key, fact_, data_.data());
         };
         
+        double fact() const { return fact_;};
+        std::vector<Value> const& data() const { return data_;};
+        
         ~Simple() = default;
     private:
         std::size_t const I_;
@@ -116,6 +119,7 @@ namespace bath {
         Hyb(jsx::value const& jParams, jsx::value const& jMatrix, jsx::value jFunctions) :
         flavors_(2*jParams("hybridisation")("matrix").size()),  //!!!!!!!!!! test against jAtomic !!!
         matrix_(flavors_*flavors_, nullptr),
+        entries_(flavors_*flavors_),
         bath_(flavors_),
         isR_(flavors_) {
             mpi::cout << "Reading in hybridisation ... " << std::flush;
@@ -124,7 +128,7 @@ namespace bath {
                 if(row.size() != jMatrix.size())
                     throw std::runtime_error("Hyb: hybridisation is not a matrix.");
 
-            ga::Join labels(jMatrix.size());
+            ga::Join labels(jMatrix.size()); std::vector<std::string> names(flavors_*flavors_);
             for(std::size_t i = 0; i < jMatrix.size(); ++i)
                 for(std::size_t j = 0; j < jMatrix.size(); ++j)
                     if(jMatrix(i)(j).string() != "") {
@@ -138,6 +142,7 @@ namespace bath {
                             data_.emplace(entry, Simple<Value>(jParams, jsx::at<io::cvec>(jFunctions(entry)), jsx::at<io::cvec>(jFunctions(entryTransp))));
 
                         matrix_[(2*i + 1)  + flavors_*2*j] = &data_.at(entry);
+                        names[(2*i + 1)  + flavors_*2*j] = entry;
                         
                         labels.join(i, j);
                     }
@@ -157,6 +162,14 @@ namespace bath {
                 
                 bath_[2*i + 1] = bath_[2*i] = labels.label(i);
             }
+            
+            std::map<std::string, std::int64_t> offsets;
+            for(auto const& function : data_) {
+                offsets[function.first] = table_.size();
+                table_.insert(table_.end(), function.second.data().begin(), function.second.data().end());
+            }
+            for(std::size_t pair = 0; pair < entries_.size(); ++pair)
+                if(matrix_[pair] != nullptr) entries_[pair] = Entry{offsets.at(names[pair]), matrix_[pair]->fact()};
 
             mpi::cout << "Ok" << std::endl;
         };
@@ -171,17 +184,56 @@ namespace bath {
         bool isR(int flavor) const { return isR_[flavor];};
         
         Value operator()(int flavorL, int flavorR, ut::KeyType key) const {
-            return key < 0 ? -matrix_[flavorL + flavors_*flavorR]->get(key + ut::KeyMax) : matrix_[flavorL + flavors_*flavorR]->get(key);
+            return matrix_[flavorL + flavors_*flavorR]->get(key);
+        };
+        
+        //dest[n] = (*this)(opsL[n].flavor(), flavorR, opsL[n].key() - keyR)
+        template<typename Ops>
+        void column(Ops const& opsL, int flavorR, ut::KeyType keyR, Value* dest) const {
+            batch(opsL.size(), dest, [&](int n, ut::KeyType& key, Entry const*& entry) {
+                key = opsL[n].key() - keyR; entry = &entries_[opsL[n].flavor() + flavors_*flavorR];
+            });
+        };
+        
+        //dest[n] = (*this)(flavorL, opsR[n].flavor(), keyL - opsR[n].key())
+        template<typename Ops>
+        void row(int flavorL, ut::KeyType keyL, Ops const& opsR, Value* dest) const {
+            batch(opsR.size(), dest, [&](int n, ut::KeyType& key, Entry const*& entry) {
+                key = keyL - opsR[n].key(); entry = &entries_[flavorL + flavors_*opsR[n].flavor()];
+            });
         };
         
     private:
+        struct Entry {
+            std::int64_t offset;
+            double fact;
+        };
+        
         int const flavors_;
         std::map<std::string, Simple<Value>> data_;
         std::vector<Simple<Value> const*> matrix_;
+        std::vector<Entry> entries_;
+        std::vector<Value> table_;
 
         std::vector<Block> blocks_;
         std::vector<int> bath_;
         std::vector<bool> isR_;
+        
+        //the keys and table offsets are gathered in chunks on the stack, since the hybridisation is shared between the threads
+        template<typename Fill>
+        void batch(int const size, Value* dest, Fill fill) const {
+            int const chunk = 64;
+            ut::KeyType keys[chunk]; std::int64_t offsets[chunk]; double facts[chunk];
+            
+            for(int start = 0; start < size; start += chunk) {
+                int const n = std::min(chunk, size - start);
+                for(int i = 0; i < n; ++i) {
+                    Entry const* entry; fill(start + i, keys[i], entry);
+                    offsets[i] = entry->offset; facts[i] = entry->fact;
+                }
+                interpolate::get(dest + start, keys, offsets, facts, table_.data(), n);
+            }
+        };
     };
 }
 
@@ -0,0 +1,86 @@
+#ifndef CTQMC_INCLUDE_BATH_INDEX_H
+#define CTQMC_INCLUDE_BATH_INDEX_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "../Utilities.h"
+
+namespace bath {
+
+    //Position of the operators in opsL/opsR by key: open addressing with linear probing in a flat table (load factor <= 1/2),
+    //erase shifts the following entries back instead of leaving tombstones
+
+    struct Index {
+        Index() : size_(0), shift_(60), slots_(16) {};
+        Index(Index const&) = default;
+        Index(Index&&) = default;
+        Index& operator=(Index const&) = default;
+        Index& operator=(Index&&) = default;
+        ~Index() = default;
+
+        std::size_t size() const { return size_;};
+
+        int& operator[](ut::KeyType key) {
+            if(2*(size_ + 1) > slots_.size()) grow();
+
+            std::size_t i = home(key);
+            for(; slots_[i].key != empty; i = next(i))
+                if(slots_[i].key == key) return slots_[i].pos;
+
+            ++size_; slots_[i].key = key; return slots_[i].pos;
+        };
+
+        int find(ut::KeyType key) const {
+            return slots_[slot(key)].pos;
+        };
+
+        void erase(ut::KeyType key) {
+            std::size_t hole = slot(key);
+            for(std::size_t i = next(hole); slots_[i].key != empty; i = next(i))
+                if(dist(home(slots_[i].key), i) >= dist(hole, i)) {
+                    slots_[hole] = slots_[i]; hole = i;
+                }
+
+            slots_[hole].key = empty; --size_;
+        };
+
+    private:
+        static constexpr ut::KeyType empty = -1;
+
+        struct Slot {
+            ut::KeyType key = empty;
+            int pos;
+        };
+
+        std::size_t size_;
+        int shift_;
+        std::vector<Slot> slots_;
+
+        std::size_t home(ut::KeyType key) const { return (static_cast<std::uint64_t>(key)*0x9E3779B97F4A7C15ull) >> shift_;};
+        std::size_t next(std::size_t i) const { return (i + 1) & (slots_.size() - 1);};
+        std::size_t dist(std::size_t from, std::size_t to) const { return (to - from) & (slots_.size() - 1);};
+
+        std::size_t slot(ut::KeyType key) const {
+            std::size_t i = home(key);
+            for(; slots_[i].key != key; i = next(i))
+                if(slots_[i].key == empty) throw std::runtime_error("bath::Index::find: key not found");
+            return i;
+        };
+
+        void grow() {
+            std::vector<Slot> slots(2*slots_.size()); slots.swap(slots_); --shift_;
+
+            for(auto const& entry : slots)
+                if(entry.key != empty) {
+                    std::size_t i = home(entry.key);
+                    while(slots_[i].key != empty) i = next(i);
+                    slots_[i] = entry;
+                }
+        };
+    };
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef CTQMC_INCLUDE_BATH_INTERPOLATE_H
+#define CTQMC_INCLUDE_BATH_INTERPOLATE_H
+
+#include <cstdint>
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+#include "../Utilities.h"
+
+//Linear interpolation of the tabulated hybridisation functions. The keys are cyclic with a sign flip for negative keys, and the lowest 10 bits
+//of a key are dropped before it is converted to double (exact below 2^52, also without AVX-512DQ). The scaling factors passed in are therefore
+//the number of grid points per 2^10 keys.
+
+namespace bath {
+
+    namespace interpolate {
+
+        int const shift = 10;
+
+        template<typename Value>
+        inline Value get(ut::KeyType key, double fact, Value const* data) {
+            bool const neg = key < 0; if(neg) key += ut::KeyMax;
+            double const it = fact*static_cast<double>(key >> shift); int const i0 = static_cast<int>(it); double const w = it - i0;
+            Value const value = (1. - w)*data[i0] + w*data[i0 + 1];
+            return neg ? -value : value;
+        };
+
+
+        //dest[n] = get(keys[n], facts[n], table + offsets[n])
+        template<typename Value>
+        inline void get(Value* dest, ut::KeyType const* keys, std::int64_t const* offsets, double const* facts, Value const* table, int n) {
+            for(int i = 0; i < n; ++i) dest[i] = get(keys[i], facts[i], table + offsets[i]);
+        };
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+
+        inline void get(double* dest, ut::KeyType const* keys, std::int64_t const* offsets, double const* facts, double const* table, int n) {
+            int i = 0;
+#if defined(__AVX512F__)
+            __m512i const keyMax = _mm512_set1_epi64(ut::KeyMax), magicBits = _mm512_castpd_si512(_mm512_set1_pd(4503599627370496.));
+            __m512d const magic = _mm512_set1_pd(4503599627370496.), one = _mm512_set1_pd(1.);
+            for(; i + 8 <= n; i += 8) {
+                __m512i key = _mm512_loadu_si512(keys + i);
+                __mmask8 const neg = _mm512_cmplt_epi64_mask(key, _mm512_setzero_si512());
+                key = _mm512_srli_epi64(_mm512_mask_add_epi64(key, neg, key, keyMax), shift);
+                __m512d const it = _mm512_mul_pd(_mm512_loadu_pd(facts + i), _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(key, magicBits)), magic));
+                __m512d const floor = _mm512_roundscale_pd(it, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                __m512d const w = _mm512_sub_pd(it, floor);
+                __m512i const index = _mm512_add_epi64(_mm512_cvtepi32_epi64(_mm512_cvttpd_epi32(floor)), _mm512_loadu_si512(offsets + i));
+                __m512d const value = _mm512_fmadd_pd(w, _mm512_i64gather_pd(index, table + 1, 8), _mm512_mul_pd(_mm512_sub_pd(one, w), _mm512_i64gather_pd(index, table, 8)));
+                _mm512_storeu_pd(dest + i, _mm512_mask_sub_pd(value, neg, _mm512_setzero_pd(), value));
+            }
+#else
+            __m256i const keyMax = _mm256_set1_epi64x(ut::KeyMax), magicBits = _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.));
+            __m256d const magic = _mm256_set1_pd(4503599627370496.), one = _mm256_set1_pd(1.), sign = _mm256_set1_pd(-.0);
+            for(; i + 4 <= n; i += 4) {
+                __m256i key = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(keys + i));
+                __m256i const neg = _mm256_cmpgt_epi64(_mm256_setzero_si256(), key);
+                key = _mm256_srli_epi64(_mm256_add_epi64(key, _mm256_and_si256(neg, keyMax)), shift);
+                __m256d const it = _mm256_mul_pd(_mm256_loadu_pd(facts + i), _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(key, magicBits)), magic));
+                __m256d const floor = _mm256_round_pd(it, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                __m256d const w = _mm256_sub_pd(it, floor);
+                __m256i const index = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_cvttpd_epi32(floor)), _mm256_loadu_si256(reinterpret_cast<__m256i const*>(offsets + i)));
+                __m256d const value = _mm256_fmadd_pd(w, _mm256_i64gather_pd(table + 1, index, 8), _mm256_mul_pd(_mm256_sub_pd(one, w), _mm256_i64gather_pd(table, index, 8)));
+                _mm256_storeu_pd(dest + i, _mm256_xor_pd(value, _mm256_and_pd(_mm256_castsi256_pd(neg), sign)));
+            }
+#endif
+            for(; i < n; ++i) dest[i] = get(keys[i], facts[i], table + offsets[i]);
+        };
+
+#endif
+
+    }
+
+}
+
+#endif
@@ -30,42 +30,39 @@ namespace bath {
         void add(Erase upd, Bath<Value> const& bath, Hyb<Value> const& hyb) {
             if(guard_) throw std::runtime_error("bath::Update<Erase>: use multi-erase, not multiple erases");
             
-            itL_ = bath.posL_.find(upd.keyL); itR_ = bath.posR_.find(upd.keyR); guard_ = true;
+            upd_ = upd; posL_ = bath.posL_.find(upd.keyL); posR_ = bath.posR_.find(upd.keyR); guard_ = true;
         };
         
         double ratio(Bath<Value> const& bath, Hyb<Value> const& hyb) {
-            return std::abs(val_ = bath.B_.at(itR_->second, itL_->second));
+            return std::abs(val_ = bath.B_.at(posR_, posL_));
         };
         
         int accept(Bath<Value>& bath, Hyb<Value> const& hyb) {
             int const N = bath.opsL_.size(); int const newN = N - 1;
-            int const posL = itL_->second; int const posR = itR_->second;
+            int const posL = posL_; int const posR = posR_;
             
-            int sign = 1;  Matrix<Value> temp(newN);
+            int sign = 1;  auto& B = bath.B_;  int const ld = B.ld();
             
             if(newN) {
                 int const inc = 1;
         
                 if(posL != newN) {
-                    swap(&N, bath.B_.data(0, newN), &inc, bath.B_.data(0, posL), &inc); sign *= -1;
+                    swap(&N, B.data(0, newN), &inc, B.data(0, posL), &inc); sign *= -1;
                     bath.posL_[bath.opsL_.back().key()] = posL; bath.opsL_[posL] = bath.opsL_.back();
                 }
                 if(posR != newN) {
-                    swap(&N, bath.B_.data(newN, 0), &N, bath.B_.data(posR, 0), &N); sign *= -1;
+                    swap(&N, B.data(newN, 0), &ld, B.data(posR, 0), &ld); sign *= -1;
                     bath.posR_[bath.opsR_.back().key()] = posR; bath.opsR_[posR] = bath.opsR_.back();
                 }
                 
-                for(int n = 0; n < newN; ++n)
-                    copy(&newN, bath.B_.data(0, n), &inc, temp.data(0, n), &inc);
-                
                 Value const fact = -1./val_;
-                geru(&newN, &newN, &fact, bath.B_.data(0, newN), &inc, bath.B_.data(newN, 0), &N, temp.data(), &newN);
+                geru(&newN, &newN, &fact, B.data(0, newN), &inc, B.data(newN, 0), &ld, B.data(), &ld);
             }
             
-            bath.B_ = std::move(temp);
+            B.resize(newN);
             
-            bath.posL_.erase(itL_); bath.opsL_.pop_back();
-            bath.posR_.erase(itR_); bath.opsR_.pop_back();
+            bath.posL_.erase(upd_.keyL); bath.opsL_.pop_back();
+            bath.posR_.erase(upd_.keyR); bath.opsR_.pop_back();
             
             bath.det_ *= val_*static_cast<double>(sign); return sign;
         };
@@ -74,10 +71,10 @@ namespace bath {
         };
         
     private:
-        bool guard_ = false; Value val_;
+        bool guard_ = false; Erase upd_; Value val_;
         
-        std::map<ut::KeyType, int>::const_iterator itL_;
-        std::map<ut::KeyType, int>::const_iterator itR_;
+        int posL_;
+        int posR_;
     };
 }
 
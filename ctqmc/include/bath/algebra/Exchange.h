@@ -27,23 +27,25 @@ namespace bath {
         };
        
         void add(Exchange upd, Bath<Value> const& bath, Hyb<Value> const& hyb) {
-            int const N = bath.opsL_.size(); std::vector<Value> vec(N);
+            int const N = bath.opsL_.size(); std::vector<Value> vec(N), vecOld(N);
 
             if(hyb.isR(upd.flavorNew)) {                                                                    // u = Delta, v = e
-                int const pos = bath.posR_.find(upd.keyOld)->second, flavorOld = bath.opsR_[pos].flavor();  auto const& ops = bath.opsL_;
+                int const pos = bath.posR_.find(upd.keyOld), flavorOld = bath.opsR_[pos].flavor();  auto const& ops = bath.opsL_;
 
-                for(int n = 0; n < N; ++n)
-                    vec[n] = hyb(ops[n].flavor(), upd.flavorNew, ops[n].key() - upd.keyNew) - hyb(ops[n].flavor(), flavorOld, ops[n].key() - upd.keyOld);
+                hyb.column(ops, upd.flavorNew, upd.keyNew, vec.data());
+                hyb.column(ops, flavorOld, upd.keyOld, vecOld.data());
+                for(int n = 0; n < N; ++n) vec[n] -= vecOld[n];
                 
                 for(auto& list : list_)
                     if(!list.isR) list.vec[pos] = vec[list.pos] = .5*(hyb(list.flavorNew, upd.flavorNew, list.keyNew - upd.keyNew) - hyb(ops[list.pos].flavor(), flavorOld, ops[list.pos].key() - upd.keyOld));
                 
                 list_.push_back({true, pos, upd.keyOld, upd.keyNew, upd.flavorNew, std::move(vec)});
             } else {                                                                                    // u = e, v = Delta
-                int const pos = bath.posL_.find(upd.keyOld)->second, flavorOld = bath.opsL_[pos].flavor();  auto const& ops = bath.opsR_;
+                int const pos = bath.posL_.find(upd.keyOld), flavorOld = bath.opsL_[pos].flavor();  auto const& ops = bath.opsR_;
                 
-                for(int n = 0; n < N; ++n)
-                    vec[n] = hyb(upd.flavorNew, ops[n].flavor(), upd.keyNew - ops[n].key()) - hyb(flavorOld, ops[n].flavor(), upd.keyOld - ops[n].key());
+                hyb.row(upd.flavorNew, upd.keyNew, ops, vec.data());
+                hyb.row(flavorOld, upd.keyOld, ops, vecOld.data());
+                for(int n = 0; n < N; ++n) vec[n] -= vecOld[n];
                 
                 for(auto& list : list_)
                     if(list.isR) list.vec[pos] = vec[list.pos] = .5*(hyb(upd.flavorNew, list.flavorNew, upd.keyNew - list.keyNew) - hyb(flavorOld, ops[list.pos].flavor(), upd.keyOld - ops[list.pos].key()));
@@ -53,11 +55,11 @@ namespace bath {
         };
         
         double ratio(Bath<Value> const& bath, Hyb<Value> const& hyb) {
-            int const inc = 1, N = bath.opsL_.size(), size = list_.size(); auto const& B = bath.B_;
+            int const inc = 1, N = bath.opsL_.size(), size = list_.size(); auto const& B = bath.B_; int const ld = B.ld();
             
             if(size == 1) {
                 auto const& list = list_[0];
-                return std::abs(detRatio_ = list.isR ? 1. + dotu(&N, B.data(list.pos, 0), &N, list.vec.data(), &inc) : 1. +  dotu(&N, list.vec.data(), &inc, B.data(0, list.pos), &inc));
+                return std::abs(detRatio_ = list.isR ? 1. + dotu(&N, B.data(list.pos, 0), &ld, list.vec.data(), &inc) : 1. +  dotu(&N, list.vec.data(), &inc, B.data(0, list.pos), &inc));
             }
             
             std::vector<Value> toInvert(size*size); auto it = toInvert.data();
@@ -65,10 +67,10 @@ namespace bath {
                 if(u_j.isR) {
                     for(auto const& v_i : list_)
                         if(v_i.isR) {                                                                  // v_i = e,      u_j = Delta
-                            *it++ = dotu(&N, B.data(v_i.pos, 0), &N, u_j.vec.data(), &inc);
+                            *it++ = dotu(&N, B.data(v_i.pos, 0), &ld, u_j.vec.data(), &inc);
                         } else {                                                                       // v_i = Delta,  u_j = Delta
                             char const no = 'n'; Value const zero = .0, one = 1.; std::vector<Value> Bu(N);
-                            gemv(&no, &N, &N, &one, B.data(), &N, u_j.vec.data(), &inc, &zero, Bu.data(), &inc);
+                            gemv(&no, &N, &N, &one, B.data(), &ld, u_j.vec.data(), &inc, &zero, Bu.data(), &inc);
                             *it++ = dotu(&N, v_i.vec.data(), &inc, Bu.data(), &inc);
                         }
                 } else
@@ -90,21 +92,21 @@ namespace bath {
         };
         
         int accept(Bath<Value>& bath, Hyb<Value> const& hyb) {
-            int const inc = 1, N = bath.opsL_.size(), size = list_.size(); auto& B = bath.B_;
+            int const inc = 1, N = bath.opsL_.size(), size = list_.size(); auto& B = bath.B_; int const ld = B.ld();
             char const no = 'n', yes = 't'; Value const zero = .0, one = 1.;
             
             std::vector<Value> BU(N*size), BtV(N*size);
             for(int k = 0; k < size; ++k) {
                 auto const& list = list_[k];
                 if(list.isR) {                                                                   // u = Delta, v = e
-                    gemv(&no, &N, &N, &one, B.data(), &N, list.vec.data(), &inc, &zero, BU.data() + N*k, &inc);
-                    copy(&N, B.data(list.pos, 0), &N, BtV.data() + N*k, &inc);
+                    gemv(&no, &N, &N, &one, B.data(), &ld, list.vec.data(), &inc, &zero, BU.data() + N*k, &inc);
+                    copy(&N, B.data(list.pos, 0), &ld, BtV.data() + N*k, &inc);
                     
                     bath.posR_.erase(list.keyOld); bath.posR_[list.keyNew] = list.pos;
                     bath.opsR_[list.pos] = Operator<Value>(list.keyNew, list.flavorNew);
                 } else {                                                                         // u = e,     v = Delta
                     copy(&N, B.data(0, list.pos), &inc, BU.data() + N*k, &inc);
-                    gemv(&yes, &N, &N, &one, B.data(), &N, list.vec.data(), &inc, &zero, BtV.data() + N*k, &inc);
+                    gemv(&yes, &N, &N, &one, B.data(), &ld, list.vec.data(), &inc, &zero, BtV.data() + N*k, &inc);
                     
                     bath.posL_.erase(list.keyOld); bath.posL_[list.keyNew] = list.pos;
                     bath.opsL_[list.pos] = Operator<Value>(list.keyNew, list.flavorNew);
@@ -113,11 +115,11 @@ namespace bath {
             
             if(size == 1) {
                 Value const fact = -1./detRatio_;
-                geru(&N, &N, &fact, BU.data(), &inc, BtV.data(), &inc, B.data(), &N);
+                geru(&N, &N, &fact, BU.data(), &inc, BtV.data(), &inc, B.data(), &ld);
             } else {
                 Value const fact = -1.;  std::vector<Value> temp(N*size);
                 gemm(&no, &no, &N, &size, &size, &one, BU.data(), &N, inv_.data(), &size, &zero, temp.data(), &N);
-                gemm(&no, &yes, &N, &N, &size, &fact, temp.data(), &N, BtV.data(), &N, &one, B.data(), &N);
+                gemm(&no, &yes, &N, &N, &size, &fact, temp.data(), &N, BtV.data(), &N, &one, B.data(), &ld);
             }
             
             bath.det_ *= detRatio_;  return 1;
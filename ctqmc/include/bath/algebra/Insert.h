@@ -36,15 +36,16 @@ namespace bath {
             
             if(N) {
                 Bv_.resize(N); vec_.resize(N);
-                for(int n = 0; n < N; ++n) vec_[n] = hyb(bath.opsL_[n].flavor(), upd.flavorR, bath.opsL_[n].key() - upd.keyR);
+                hyb.column(bath.opsL_, upd.flavorR, upd.keyR, vec_.data());
                 
                 char const no = 'n';
                 int const inc = 1;
                 Value const zero = .0;
                 Value const one = 1.;
-                gemv(&no, &N, &N, &one, bath.B_.data(), &N, vec_.data(), &inc, &zero, Bv_.data(), &inc);
+                int const ld = bath.B_.ld();
+                gemv(&no, &N, &N, &one, bath.B_.data(), &ld, vec_.data(), &inc, &zero, Bv_.data(), &inc);
                 
-                for(int n = 0; n < N; ++n) vec_[n] = hyb(upd.flavorL, bath.opsR_[n].flavor(), upd.keyL - bath.opsR_[n].key());
+                hyb.row(upd.flavorL, upd.keyL, bath.opsR_, vec_.data());
                 val_ -= dotu(&N, vec_.data(), &inc, Bv_.data(), &inc);
             }
             
@@ -57,15 +58,14 @@ namespace bath {
 
         int accept(Bath<Value>& bath, Hyb<Value> const& hyb) {
             int const N = bath.opsL_.size();
-            int const newN = N + 1;
             
             bath.posL_[upd_.keyL] = bath.opsL_.size(); bath.opsL_.push_back(Operator<Value>(upd_.keyL, upd_.flavorL));
             bath.posR_[upd_.keyR] = bath.opsR_.size(); bath.opsR_.push_back(Operator<Value>(upd_.keyR, upd_.flavorR));
             
-            Matrix<Value> temp(newN);
+            auto& B = bath.B_;  B.resize(N + 1);  int const ld = B.ld();
             
             Value fact = 1./val_;
-            temp.at(N, N) = fact;
+            B.at(N, N) = fact;
             
             if(N) {
                 std::vector<Value> hBTilde(N);
@@ -74,22 +74,19 @@ namespace bath {
                 int const inc = 1;
                 Value const zero = .0;
                 Value const one = 1.;
-                gemv(&yes, &N, &N, &fact, bath.B_.data(), &N, vec_.data(), &inc, &zero, hBTilde.data(), &inc);
-                geru(&N, &N, &one, Bv_.data(), &inc, hBTilde.data(), &inc, bath.B_.data(), &N);
-                
-                for(int n = 0; n < N; ++n)
-                    copy(&N, bath.B_.data(0, n), &inc, temp.data(0, n), &inc);
+                gemv(&yes, &N, &N, &fact, B.data(), &ld, vec_.data(), &inc, &zero, hBTilde.data(), &inc);
+                geru(&N, &N, &one, Bv_.data(), &inc, hBTilde.data(), &inc, B.data(), &ld);
                 
                 fact = -1./val_;
                 scal(&N, &fact, Bv_.data(), &inc);
-                copy(&N, Bv_.data(), &inc, temp.data(0, N), &inc);
+                copy(&N, Bv_.data(), &inc, B.data(0, N), &inc);
                 
                 Value const minus = -1.;
                 scal(&N, &minus, hBTilde.data(), &inc);
-                copy(&N, hBTilde.data(), &inc, temp.data(N, 0), &newN);
+                copy(&N, hBTilde.data(), &inc, B.data(N, 0), &ld);
             }
             
-            bath.B_ = std::move(temp);  bath.det_ *= val_; return 1;
+            bath.det_ *= val_; return 1;
         };
         
         void reject(Bath<Value>& bath, Hyb<Value> const& hyb) {
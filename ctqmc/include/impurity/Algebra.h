@@ -1,6 +1,7 @@
 #ifndef CTQMC_INCLUDE_IMPURITY_ALGEBRA_H
 #define CTQMC_INCLUDE_IMPURITY_ALGEBRA_H
 
+#include <cstdint>
 #include <cmath>
 #include <iostream>
 #include <vector>
@@ -14,6 +15,9 @@ namespace imp {
         struct Batcher {
             virtual int is_ready() = 0;
             virtual void launch() = 0;
+            virtual void precision(std::int64_t& checks, std::int64_t& fallbacks, double& error) const {};  // accuracy checks of reduced precision backends
+            virtual int sectors() const { return 1;};  // number of sectors DensityMatrix::decide hands over at once
+            virtual void task() {};                    // the following operations do not depend on the ones since the last task (c.f. DensityMatrix::decide)
             virtual ~Batcher() = default;
         };
         
@@ -33,6 +37,21 @@ namespace imp {
     
     template<typename Mode, typename Value> struct Matrix;
     
+    struct Memory;
+    
+    
+    //dest = prop*L*R. Backends without a fused kernel fall back to mult followed by evolveL.
+    template<typename Mode, typename Value>
+    void multEvolveL(Matrix<Mode, Value>& dest, Vector<Mode> const& prop, Matrix<Mode, Value> const& L, Matrix<Mode, Value> const& R, itf::Batcher<Value>& batcher) {
+        mult(dest, L, R, batcher); evolveL(prop, dest, batcher);
+    };
+    
+    //Backends without sparse kernels keep all operator blocks dense
+    template<typename Mode, typename Value>
+    bool sparsify(Matrix<Mode, Value>& matrix, double fill) {
+        return false;
+    };
+    
 }
 
 
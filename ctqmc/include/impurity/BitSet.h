@@ -29,6 +29,9 @@ namespace imp {
         void set(std::size_t pos) {
             data_[pos/sizeof(data_type)] |= (static_cast<data_type>(1) << pos%sizeof(data_type));
         };
+        void reset() {
+            std::memset(data_, 0, size_*sizeof(data_type));
+        };
        
     private:
         std::size_t const size_;
@@ -48,13 +48,13 @@ namespace imp {
         typedef std::vector<int>::const_iterator iterator;
         
         DensityMatrix() = default;
-        DensityMatrix(itf::Product<Value>& product, itf::EigenValues const& eig) :
+        //Only the sectors in source are traced over (all sectors unless some are pruned, c.f. Pruning.h)
+        DensityMatrix(itf::Product<Value>& product, itf::EigenValues const& eig, std::vector<int> const& source) :
         level_(product.height()),
         Z_(.0), z_(eig.sectorNumber() + 1) {
-            std::vector<int> source(eig.sectorNumber()); std::iota(source.begin(), source.end(), 1);
             std::vector<int> target = get<Mode>(product).map(get<Mode>(product).first(), level_, source);
 
-            for(int i = 0; i < eig.sectorNumber(); ++i)
+            for(std::size_t i = 0; i < source.size(); ++i)
                 if(target[i] == source[i])
                     bounds_.push_back({source[i], get<Mode>(product).first()->op(level_)->map(source[i]).norm, ut::Zahl<double>()});
         };
@@ -75,22 +75,32 @@ namespace imp {
             for(auto it = bounds_.end() - 1; it != bounds_.begin(); --it) (it - 1)->value += it->value;
             bounds_.push_back({0, .0, ut::Zahl<double>(.0)});
 
-            bound_ = bounds_.begin(); return ut::Flag::Pending;
+            bound_ = evaluated_ = bounds_.begin(); return ut::Flag::Pending;
         };
 
+        //Each call hands the next batcher.sectors() sectors over to the batcher. Their traces are added one by one in the order of the bounds on
+        //the next call, with the reject and accept checks in between, so the decision does not depend on how many sectors are evaluated at once.
         ut::Flag decide(ut::Zahl<double> const& thresh, itf::Product<Value>& product, itf::Batcher<Value>& batcher) {
-            if(ut::abs(Z_) + bound_->value <= ut::abs(thresh)) {
-                return ut::Flag::Reject;
-            } else if(bound_->value <= std::numeric_limits<double>::epsilon()*ut::abs(Z_)) {
-                op_ = get<Mode>(product).first()->get_op(level_);
-                return ut::Flag::Accept;
+            for(;; ++bound_) {
+                if(ut::abs(Z_) + bound_->value <= ut::abs(thresh)) {
+                    return ut::Flag::Reject;
+                } else if(bound_->value <= std::numeric_limits<double>::epsilon()*ut::abs(Z_)) {
+                    op_ = get<Mode>(product).first()->get_op(level_);
+                    return ut::Flag::Accept;
+                }
+                
+                if(bound_ == evaluated_) break;
+                
+                sectors_.push_back(bound_->sec); Z_ += z_[bound_->sec];
+            }
+            
+            for(int slot = 0; slot < batcher.sectors() && evaluated_ + 1 != bounds_.end(); ++slot, ++evaluated_) {
+                batcher.task();
+                get<Mode>(product).multiply(get<Mode>(product).first(), level_, evaluated_->sec, batcher, slot);
+                trace(&z_[evaluated_->sec], static_cast<ut::Zahl<Value>*>(nullptr), get<Mode>(product).first()->op(level_)->mat(evaluated_->sec), batcher);
             }
-
-            sectors_.push_back(bound_->sec);
-            get<Mode>(product).multiply(get<Mode>(product).first(), level_, bound_->sec, batcher);
-            trace(&z_[bound_->sec], &Z_, get<Mode>(product).first()->op(level_)->mat(bound_->sec), batcher);
             
-            ++bound_; return ut::Flag::Pending;
+            return ut::Flag::Pending;
         };
         
         std::vector<int>::const_iterator begin() const { return sectors_.begin();};
@@ -109,7 +119,7 @@ namespace imp {
         int level_;
         std::vector<int> sectors_;
         std::vector<Bound> bounds_;
-        std::vector<Bound>::iterator bound_;
+        std::vector<Bound>::iterator bound_, evaluated_;  // sectors before evaluated_ are handed over to the batcher, those before bound_ are in Z_
         
         ut::Zahl<Value> Z_; std::vector<ut::Zahl<Value>> z_;
     };
@@ -75,7 +75,7 @@ namespace imp {
     template<typename Mode>
 	struct Propagator {
         Propagator() = delete;
-        Propagator(double time, EigenValues<Mode> const& eig) : eig_(eig), time_(time), isProp_(eig_.sectorNumber() + 1), prop_(static_cast<Vector<Mode>*>(::operator new(sizeof(Vector<Mode>)*(eig_.sectorNumber() + 1)))) {}; /////////!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+        Propagator(double time, EigenValues<Mode> const& eig, Memory* memory = nullptr) : eig_(eig), memory_(memory), time_(time), isProp_(eig_.sectorNumber() + 1), prop_(static_cast<Vector<Mode>*>(::operator new(sizeof(Vector<Mode>)*(eig_.sectorNumber() + 1)))) {}; /////////!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
         Propagator(Propagator const&) = delete;
         Propagator(Propagator&&) = delete;
         Propagator& operator=(Propagator const&) = delete;
@@ -83,7 +83,8 @@ namespace imp {
         double time() const { return time_;};
 		Vector<Mode> const& at(int s) {
 			if(isProp_[s]) return prop_[s];
-            new(prop_ + s) Vector<Mode>(time_, eig_.at(s)); isProp_.set(s); // Soetti ok sii so, oder ???
+            if(memory_) new(prop_ + s) Vector<Mode>(time_, eig_.at(s), *memory_); else new(prop_ + s) Vector<Mode>(time_, eig_.at(s));
+            isProp_.set(s); // Soetti ok sii so, oder ???
             return prop_[s];
 		};
         Vector<Mode> const& at(int s) const {
@@ -94,15 +95,22 @@ namespace imp {
 			for(SectorNormPtrs::iterator it = norms.begin; it != norms.end; ++it) 
 			    (*it)->norm += time_*eig_.at((*it)->sector).min();
 		};
+        void clear() {
+            if(isProp_.any()) for(int s = eig_.sectorNumber(); s; --s) if(isProp_[s]) prop_[s].~Vector();
+            isProp_.reset();
+        };
+        void reset(double time) {
+            clear(); time_ = time;
+        };
 		~Propagator() { 
-			if(isProp_.any()) for(int s = eig_.sectorNumber(); s; --s) if(isProp_[s]) prop_[s].~Vector();
-            ::operator delete(prop_);
+            clear(); ::operator delete(prop_);
 		};
         
 	private:
 		EigenValues<Mode> const& eig_;
+        Memory* const memory_;
 
-		double const time_;
+		double time_;
         BitSet isProp_;     //eleganz vo arsch vo chue aber z'schnellschte won ich bis jetzt gfunde han
 		Vector<Mode>* const prop_;
 	};
@@ -0,0 +1,58 @@
+#ifndef CTQMC_INCLUDE_IMPURITY_MEMORY_H
+#define CTQMC_INCLUDE_IMPURITY_MEMORY_H
+
+#include <cstdint>
+#include <vector>
+#include <new>
+
+
+namespace imp {
+    
+    //Recycles the memory blocks of one Markov chain (skip-list nodes, sector matrices and propagators), such that the
+    //insert/erase -> accept/reject cycle does not go to the global heap. Blocks are binned in power of two size classes.
+    //Not thread safe, every Product owns its own pool.
+    struct Memory {
+        Memory() : hits_(0), misses_(0) {};
+        Memory(Memory const&) = delete;
+        Memory(Memory&&) = delete;
+        Memory& operator=(Memory const&) = delete;
+        Memory& operator=(Memory&&) = delete;
+        ~Memory() {
+            for(auto& blocks : free_)
+                for(auto ptr : blocks) ::operator delete(ptr);
+        };
+        
+        void* allocate(std::size_t bytes) {
+            auto const c = size_class(bytes);
+            if(c >= free_.size()) free_.resize(c + 1);
+            
+            if(free_[c].size()) {
+                ++hits_; void* ptr = free_[c].back(); free_[c].pop_back(); return ptr;
+            }
+            ++misses_; return ::operator new(static_cast<std::size_t>(1) << c);
+        };
+        void free(void* ptr, std::size_t bytes) {
+            free_[size_class(bytes)].push_back(ptr);
+        };
+        
+        template<typename T> T* allocate(std::size_t n) { return static_cast<T*>(allocate(n*sizeof(T)));};
+        template<typename T> void free(T* ptr, std::size_t n) { free(static_cast<void*>(ptr), n*sizeof(T));};
+        
+        std::int64_t hits() const { return hits_;};
+        std::int64_t misses() const { return misses_;};
+        
+    protected:
+        std::int64_t hits_, misses_;
+        
+    private:
+        std::vector<std::vector<void*>> free_;
+        
+        static std::size_t size_class(std::size_t bytes) {
+            std::size_t c = 4; while((static_cast<std::size_t>(1) << c) < bytes) ++c;
+            return c;
+        };
+    };
+    
+}
+
+#endif
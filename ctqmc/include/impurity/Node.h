@@ -6,6 +6,7 @@
 
 #include "Diagonal.h"
 #include "Operators.h"
+#include "Pool.h"
 #include "../Utilities.h"
 
 namespace imp {
@@ -15,15 +16,16 @@ namespace imp {
     template<typename NodeValue>
     struct Node {
         template<typename... Args>
-        Node(ut::KeyType key, int height, Args&&... args) :
+        Node(Memory& memory, ut::KeyType key, int height, Args&&... args) :
         key(key), height(height),
-        next(new Node*[2*height]),
-        entries(new int[2*height]),
+        next(memory.allocate<Node*>(2*height)),
+        entries(memory.allocate<int>(2*height)),
         touched(0),
-        value(this, std::forward<Args>(args)...) {
+        value(this, std::forward<Args>(args)...),
+        memory_(memory) {
         };
         ~Node() {
-            delete[] entries; delete[] next;
+            memory_.free(entries, 2*height); memory_.free(next, 2*height);
         };
         
         ut::KeyType const key; int const height;
@@ -46,6 +48,9 @@ namespace imp {
         };
 
         int touched; NodeValue value;
+        
+    private:
+        Memory& memory_;
     };
     
     
@@ -81,16 +86,16 @@ namespace imp {
     
     template<typename Mode, typename Value>
     struct NodeValue {
-        NodeValue(Access<NodeValue const> node, itf::Operator<Value> const* op0, int flavor, EigenValues<Mode> const& eig) :
+        NodeValue(Access<NodeValue const> node, Pool<Mode, Value>& pool, itf::Operator<Value> const* op0, int flavor) :
         op0(&get<Mode, Value>(*op0)), flavor(flavor),
-        eig_(eig), node_(node),
+        pool_(pool), node_(node),
         prop_(nullptr), propTry_(nullptr),
-        ops_(new Operator<Mode, Value>*[2*node_.height()]), opsTry_(ops_ + node_.height()) {
+        ops_(pool_.template allocate<Operator<Mode, Value>*>(2*node_.height())), opsTry_(ops_ + node_.height()) {
             for(int l = 0; l < 2*node_.height(); ++l) ops_[l] = nullptr;
         };
         ~NodeValue() {
-            for(int l = 0; l < 2*node_.height(); ++l) delete ops_[l]; 
-            delete[] ops_; delete propTry_; delete prop_;
+            for(int l = 0; l < 2*node_.height(); ++l) pool_.release(ops_[l]);
+            pool_.free(ops_, 2*node_.height()); pool_.release(propTry_); pool_.release(prop_);
         };
         
         Operator<Mode, Value> const* const op0;
@@ -115,32 +120,32 @@ namespace imp {
 
         Propagator<Mode>* prop() {
             auto& prop = node_.touched() ? prop_ : propTry_;
-            return prop ? prop : prop = new Propagator<Mode>(-(node_.next(0).key() - node_.key())*ut::beta()/ut::KeyMax, eig_);  //promotion stuff ...
+            return prop ? prop : prop = pool_.prop(node_.next(0).key() - node_.key());
         };
         Operator<Mode, Value>* op(int l) {
             auto& op = l < node_.touched() ? ops_[l] : opsTry_[l];
-            return op ? op : op = new Operator<Mode, Value>(eig_);
+            return op ? op : op = pool_.op();
         };
         
         void accept() {
             if(!node_.touched()) {
-                delete prop_; prop_ = propTry_; propTry_ = nullptr;
+                pool_.release(prop_); prop_ = propTry_; propTry_ = nullptr;
             }
             for(int l = std::max(node_.touched(), 1); l < node_.height(); ++l) {
-                delete ops_[l]; ops_[l] = opsTry_[l]; opsTry_[l] = nullptr;
+                pool_.release(ops_[l]); ops_[l] = opsTry_[l]; opsTry_[l] = nullptr;
             }
         };
         void reject() {
             if(!node_.touched()) {
-                delete propTry_; propTry_ = nullptr;
+                pool_.release(propTry_); propTry_ = nullptr;
             }
             for(int l = std::max(node_.touched(), 1); l < node_.height(); ++l) {
-                delete opsTry_[l]; opsTry_[l] = nullptr;
+                pool_.release(opsTry_[l]); opsTry_[l] = nullptr;
             }
         };
         
     private:
-        EigenValues<Mode> const& eig_;
+        Pool<Mode, Value>& pool_;
         Access<NodeValue const> node_;
         
         Propagator<Mode>* prop_; Propagator<Mode>* propTry_;
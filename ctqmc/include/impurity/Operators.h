@@ -47,7 +47,8 @@ namespace imp {
         isMap_(eig_.sectorNumber() + 1),
         isMat_(eig_.sectorNumber() + 1),
         map_(new SectorNorm[eig_.sectorNumber() + 1]),
-        mat_(static_cast<Matrix<Mode, Value>*>(::operator new(sizeof(Matrix<Mode, Value>)*(eig_.sectorNumber() + 1)))) {
+        mat_(static_cast<Matrix<Mode, Value>*>(::operator new(sizeof(Matrix<Mode, Value>)*(eig_.sectorNumber() + 1)))),
+        blocks_(0), sparseBlocks_(0) {
         };
         
         Operator(char const option, itf::EigenValues const& eigItf) : Operator(eigItf) {
@@ -62,7 +63,8 @@ namespace imp {
         
         //Supports parallelization by pre-computing norms
         //otherwise, if no norms are passed, each rank computes all norms
-        Operator(jsx::value const& jOperator, itf::EigenValues const& eigItf, io::rvec const& norms = {}) : Operator(eigItf) {
+        //Blocks with at most the fraction fill of non-zero entries are also stored sparse (c.f. sparsify)
+        Operator(jsx::value const& jOperator, itf::EigenValues const& eigItf, io::rvec const& norms = {}, double fill = .0) : Operator(eigItf) {
             if(static_cast<int>(jOperator.size()) != eig_.sectorNumber())
                 throw(std::runtime_error("Tr: wrong number of sectors."));
             
@@ -89,6 +91,8 @@ namespace imp {
                     if(norm != .0) {
                         set_map(start_sector) = { target_sector, std::log(norm) };
                         mat(start_sector, eig_.at(target_sector).dim(), eig_.at(start_sector).dim(), matrix);
+                        
+                        ++blocks_; if(fill > .0 && sparsify(mat(start_sector), fill)) ++sparseBlocks_;
                     } else
                         set_map(start_sector) = { 0, .0 };
                     
@@ -103,10 +107,17 @@ namespace imp {
         Operator& operator=(Operator const&) = delete;
         Operator& operator=(Operator&&) = delete;
         ~Operator() {
+            clear(); ::operator delete(mat_); delete [] map_;
+        };
+        
+        void clear() {
             if(isMat_.any()) for(int s = eig_.sectorNumber(); s; --s) if(isMat_[s]) mat_[s].~Matrix();
-            ::operator delete(mat_); delete [] map_;
+            isMat_.reset(); isMap_.reset();
         };
         
+        int blocks() const { return blocks_;};
+        int sparseBlocks() const { return sparseBlocks_;};
+        
         int isMap(int s) const { return isMap_[s];};
         SectorNorm& set_map(int s) { isMap_.set(s); return map_[s];};
         
@@ -167,6 +178,7 @@ namespace imp {
         BitSet isMap_, isMat_;
         SectorNorm* const map_;
         Matrix<Mode, Value>* const mat_;
+        int blocks_, sparseBlocks_;
     };
     
     template<typename Mode, typename Value> Operator<Mode, Value>& get(itf::Operator<Value>& operatorItf) {
@@ -188,18 +200,25 @@ namespace imp {
             mpi::cout << "Reading operators ... " << std::flush;
             
             auto norms = gatherNorms<Value>(jParams("mpi structure"), jOperators);
+            double const fill = jParams.is("sparse operators") ? jParams("sparse operators").real64() : .0;
             
-            int i = 0;
+            int i = 0, blocks = 0, sparseBlocks = 0;
             for(auto& jOp : jOperators.array()) {
                 jsx::value jOpDagg = linalg::conj<Value>(jOp);
                 
-                new(ops_ + 2*i    ) Operator<Mode, Value>(jOp, eigItf, norms.norms()[i]);
-                new(ops_ + 2*i + 1) Operator<Mode, Value>(jOpDagg, eigItf, norms.normsDagg()[i]);
+                new(ops_ + 2*i    ) Operator<Mode, Value>(jOp, eigItf, norms.norms()[i], fill);
+                new(ops_ + 2*i + 1) Operator<Mode, Value>(jOpDagg, eigItf, norms.normsDagg()[i], fill);
+                
+                for(int f = 2*i; f < 2*i + 2; ++f) {
+                    blocks += ops_[f].blocks(); sparseBlocks += ops_[f].sparseBlocks();
+                }
                 
                 ++i;
             }
             
-            mpi::cout << "Ok" << std::endl;
+            mpi::cout << "Ok";
+            if(fill > .0) mpi::cout << " (" << sparseBlocks << " of " << blocks << " blocks sparse)";
+            mpi::cout << std::endl;
         }
         Operators(Operators const&) = delete;
         Operators(Operators&&) = delete;
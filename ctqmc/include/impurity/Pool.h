@@ -0,0 +1,118 @@
+#ifndef CTQMC_INCLUDE_IMPURITY_POOL_H
+#define CTQMC_INCLUDE_IMPURITY_POOL_H
+
+#include <cstdint>
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+#include "Algebra.h"
+#include "Memory.h"
+#include "Diagonal.h"
+#include "Operators.h"
+#include "../Utilities.h"
+
+
+namespace imp {
+    
+    //On top of the raw blocks, operators and propagators of rejected or replaced nodes are kept alive and handed out
+    //again, which saves the bookkeeping allocations of their sector tables.
+    //
+    //If "propagator cache" is set, propagators are in addition shared between all nodes with the same key interval, and
+    //up to that many propagators which are no longer referenced are kept in a least-recently-used list, such that a
+    //re-proposed interval does not recompute the exponentials. These hits are counted apart from the ones of the pool.
+    template<typename Mode, typename Value>
+    struct Pool : Memory {
+        Pool() = delete;
+        Pool(EigenValues<Mode> const& eig, std::size_t cache = 0) : eig_(eig), cache_(cache), cacheHits_(0) {};
+        Pool(Pool const&) = delete;
+        Pool(Pool&&) = delete;
+        Pool& operator=(Pool const&) = delete;
+        Pool& operator=(Pool&&) = delete;
+        ~Pool() {
+            for(auto op : ops_) delete op;
+            for(auto prop : props_) delete prop;
+            for(auto& entry : cached_) delete entry.second;
+        };
+        
+        EigenValues<Mode> const& eig() const { return eig_;};
+        
+        std::int64_t cacheHits() const { return cacheHits_;};
+        
+        Operator<Mode, Value>* op() {
+            if(ops_.size()) {
+                ++hits_; auto op = ops_.back(); ops_.pop_back(); return op;
+            }
+            ++misses_; return new Operator<Mode, Value>(eig_);
+        };
+        void release(Operator<Mode, Value>* op) {
+            if(op == nullptr) return;
+            op->clear(); ops_.push_back(op);
+        };
+        
+        Propagator<Mode>* prop(ut::KeyType interval) {
+            if(!cache_) return fresh(interval);
+            
+            auto it = cached_.find(interval);
+            if(it != cached_.end()) {
+                ++cacheHits_; auto prop = it->second;
+                if(!prop->refs++) lru_.erase(prop->pos);
+                return prop;
+            }
+            
+            auto prop = fresh(interval); cached_[interval] = prop;
+            return prop;
+        };
+        void release(Propagator<Mode>* ptr) {
+            if(ptr == nullptr) return;
+            auto prop = static_cast<CachedPropagator*>(ptr);
+            
+            if(!cache_) return recycle(prop);
+            
+            if(--prop->refs) return;
+            lru_.push_front(prop); prop->pos = lru_.begin();
+            
+            if(lru_.size() > cache_) {
+                cached_.erase(lru_.back()->interval); recycle(lru_.back()); lru_.pop_back();
+            }
+        };
+        
+    private:
+        struct CachedPropagator : Propagator<Mode> {
+            CachedPropagator(ut::KeyType interval, EigenValues<Mode> const& eig, Memory* memory) :
+            Propagator<Mode>(time(interval), eig, memory), interval(interval), refs(1) {};
+            
+            ut::KeyType interval; int refs;
+            typename std::list<CachedPropagator*>::iterator pos;
+        };
+        
+        EigenValues<Mode> const& eig_;
+        std::size_t const cache_;
+        std::int64_t cacheHits_;
+        
+        std::vector<Operator<Mode, Value>*> ops_;
+        std::vector<CachedPropagator*> props_;
+        
+        std::unordered_map<ut::KeyType, CachedPropagator*> cached_;
+        std::list<CachedPropagator*> lru_;
+        
+        static double time(ut::KeyType interval) {
+            return -interval*ut::beta()/ut::KeyMax;  //promotion stuff ...
+        };
+        
+        CachedPropagator* fresh(ut::KeyType interval) {
+            if(props_.size()) {
+                ++hits_; auto prop = props_.back(); props_.pop_back();
+                prop->reset(time(interval)); prop->interval = interval; prop->refs = 1;
+                return prop;
+            }
+            ++misses_; return new CachedPropagator(interval, eig_, this);
+        };
+        void recycle(CachedPropagator* prop) {
+            prop->clear(); props_.push_back(prop);
+        };
+    };
+    
+}
+
+#endif
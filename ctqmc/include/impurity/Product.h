@@ -6,6 +6,7 @@
 
 #include "Algebra.h"
 #include "Node.h"
+#include "Pool.h"
 #include "../Utilities.h"
 #include "../../../include/JsonX.h"
 
@@ -21,6 +22,8 @@ namespace imp {
             virtual void erase(ut::KeyType key) = 0;
             virtual int accept() = 0;
             virtual void reject() = 0;
+            virtual Memory const& memory() const = 0;
+            virtual std::int64_t cacheHits() const = 0;
             virtual ~Product() = default;
         };
         
@@ -39,6 +42,7 @@ namespace imp {
         Product() = delete;
         Product(jsx::value const& jParams, itf::EigenValues const& eig, itf::Operator<Value> const& ide, itf::Operators<Value> const& ops) :
         eig_(get<Mode>(eig)), ide_(get<Mode>(ide)), ops_(get<Mode>(ops)),
+        pool_(eig_, jParams.is("propagator cache") ? jParams("propagator cache").int64() : 0),
         urng_(std::mt19937(234), std::uniform_real_distribution<double>(.0, 1.)),
 		prob_(jParams.is("skip-list probability") ? jParams("skip-list probability").real64() : .5),
 		baseProb_(std::pow(prob_, (jParams.is("skip-list shift") ? jParams("skip-list shift").int64() : 0) + 1)),
@@ -46,17 +50,17 @@ namespace imp {
 		height_(1), heightBackup_(1),
 		size_(0), sizeBackup_(0),
         sign_(1),
-        first_(new NodeType(         0, maxHeight_ + 1,   &ide_, -1, eig_)),
-        last_( new NodeType(ut::KeyMax,              0, nullptr, -1, eig_)) {
+        first_(create(         0, maxHeight_ + 1,   &ide_, -1)),
+        last_( create(ut::KeyMax,              0, nullptr, -1)) {
             for(int l = 0; l <= height_; ++l) { first_->next[l] = last_; first_->entries[l] = size_ + 1;}
             first_->accept();
             
             all_.begin = new SectorNorm*[(maxHeight_ + 2)*eig.sectorNumber()];
             
-            int maxDim = 0; for(int s = eig.sectorNumber(); s; --s) maxDim = std::max(eig_.at(s).dim(), maxDim);
-            bufferA_.reset(new Matrix<Mode, Value>(maxDim*maxDim));
-            bufferB_.reset(new Matrix<Mode, Value>(maxDim*maxDim));
-            bufferC_.reset(new Matrix<Mode, Value>(maxDim*maxDim));
+            maxDim_ = 0; for(int s = eig.sectorNumber(); s; --s) maxDim_ = std::max(eig_.at(s).dim(), maxDim_);
+            bufferA_.reset(new Matrix<Mode, Value>(maxDim_*maxDim_));
+            bufferB_.reset(new Matrix<Mode, Value>(maxDim_*maxDim_));
+            bufferC_.reset(new Matrix<Mode, Value>(maxDim_*maxDim_));
 		};
         Product(Product const&) = delete;
         Product(Product&&) = delete;
@@ -71,9 +75,9 @@ namespace imp {
             while(it != last_) {
                 auto temp = it;
                 it = it->next[0];
-                delete temp;
+                destroy(temp);
             }
-            delete last_;
+            destroy(last_);
         };
 
         int size() const { return size_;};
@@ -83,15 +87,15 @@ namespace imp {
         CAccessType last() const { return last_;};
         
         bool insert(ut::KeyType const key, int flavor) {
-            return last() != insert_impl(key, random_height(), &ops_.at(flavor), flavor, eig_);
+            return last() != insert_impl(key, random_height(), &ops_.at(flavor), flavor);
         };
         // Todo: remove flavor entry
         CAccessType insert(ut::KeyType const key, itf::Operator<Value> const* op, int flavor) {
-            return insert_impl(key, random_height(), &get<Mode>(*op), flavor, eig_);
+            return insert_impl(key, random_height(), &get<Mode>(*op), flavor);
         };
         CAccessType insert(ut::KeyType const key, itf::Operator<Value> const* op, int flavor, int height) {
             if(height > maxHeight_ + 1) throw std::runtime_error("imp::Product::insert: invalid height");
-            return insert_impl(key, height, &get<Mode>(*op), flavor, eig_);
+            return insert_impl(key, height, &get<Mode>(*op), flavor);
         };
         
         void erase(ut::KeyType key) {
@@ -108,14 +112,21 @@ namespace imp {
 
             return result;
         };
-        void multiply(CAccessType cbegin, int level, int sec, itf::Batcher<Value>& batcher) {
+        //Chains with different slots use different intermediate buffers, such that a batcher may evaluate them concurrently (c.f. DensityMatrix::decide)
+        void multiply(CAccessType cbegin, int level, int sec, itf::Batcher<Value>& batcher, int slot = 0) {
             auto begin = AccessType(cbegin.node_); if(begin->op(level)->isMat(sec)) return;
 
             if(begin.next(level) != begin.next(0)) {
                 if(size_ + 2 > ptrMat_.size()) { ptrMat_.resize(size_ + 2); ptrProp_.resize(size_ + 2);}
-                multiply_impl(begin, level, sec,  ptrMat_.data(), ptrProp_.data(), bufferA_.get(), bufferB_.get(), batcher);
+                if(slot == 0) {
+                    multiply_impl(begin, level, sec,  ptrMat_.data(), ptrProp_.data(), bufferA_.get(), bufferB_.get(), pool_, batcher);
+                } else {
+                    if(2*slot > static_cast<int>(slots_.size())) slots_.resize(2*slot);
+                    for(int i = 2*slot - 2; i < 2*slot; ++i) if(!slots_[i]) slots_[i].reset(new Matrix<Mode, Value>(maxDim_*maxDim_));
+                    multiply_impl(begin, level, sec,  ptrMat_.data(), ptrProp_.data(), slots_[2*slot - 2].get(), slots_[2*slot - 1].get(), pool_, batcher);
+                }
             } else {
-                copyEvolveL(begin->op(level)->mat(sec, ide_.mat(sec).I()*ide_.mat(sec).J()), begin->prop()->at(sec), begin->op0->mat(sec), batcher);
+                copyEvolveL(begin->op(level)->mat(sec, ide_.mat(sec).I()*ide_.mat(sec).J(), pool_), begin->prop()->at(sec), begin->op0->mat(sec), batcher);
                 auto& map = begin->op(level)->set_map(sec); map.sector = begin->op0->map(sec).sector; norm(&map.norm, begin->op(level)->mat(sec), batcher);
             }
         };
@@ -125,7 +136,7 @@ namespace imp {
 			
             for(auto ptr : touched_) ptr->accept();
             for(auto ptr : inserted_) ptr->accept();
-            for(auto ptr : erased_) delete ptr;
+            for(auto ptr : erased_) destroy(ptr);
 			
 			touched_.clear(); inserted_.clear(); erased_.clear();
 
@@ -137,7 +148,7 @@ namespace imp {
 			height_ = heightBackup_;
 			
             for(auto ptr : touched_) ptr->reject();
-            for(auto ptr : inserted_) delete ptr;
+            for(auto ptr : inserted_) destroy(ptr);
 			
 			touched_.clear(); inserted_.clear(); erased_.clear();
 
@@ -149,12 +160,17 @@ namespace imp {
         Matrix<Mode, Value>& bufferA() { return *bufferA_;};
         Matrix<Mode, Value>& bufferB() { return *bufferB_;};
         Matrix<Mode, Value>& bufferC() { return *bufferC_;};
+        
+        Memory const& memory() const { return pool_;};
+        std::int64_t cacheHits() const { return pool_.cacheHits();};
 
     private:
         EigenValues<Mode> const& eig_;
         Operator<Mode, Value> const& ide_;
         Operators<Mode, Value> const& ops_;
         
+        Pool<Mode, Value> pool_;
+        
 		ut::RandomNumberGenerator<std::mt19937, std::uniform_real_distribution<double> > urng_;
 		
 		double const prob_; 
@@ -172,7 +188,9 @@ namespace imp {
         
         std::vector<Matrix<Mode, Value> const*> ptrMat_;
         std::vector<Vector<Mode> const*> ptrProp_;
+        int maxDim_;
         std::unique_ptr<Matrix<Mode, Value>> bufferA_, bufferB_, bufferC_;
+        std::vector<std::unique_ptr<Matrix<Mode, Value>>> slots_;  // intermediate buffers of the slots > 0
 
 
 		int random_height() {
@@ -181,6 +199,15 @@ namespace imp {
 			return h;
         };
         
+        template<typename... Args>
+        NodeType* create(ut::KeyType const key, int const height, Args&&... args) {
+            return new(pool_.template allocate<NodeType>(1)) NodeType(pool_, key, height, pool_, std::forward<Args>(args)...);
+        };
+        
+        void destroy(NodeType* node) {
+            node->~NodeType(); pool_.free(node, 1);
+        };
+        
         template<typename... Args>
         NodeType* insert_impl(ut::KeyType const key, int const newHeight, Args&&... args) {
             if(!(0 <= key && key <= ut::KeyMax)) throw std::runtime_error("imp::Product::insert_impl: invalid key");
@@ -203,7 +230,7 @@ namespace imp {
                 node[l] = first_; pos[l] = 0; first_->next[l] = last_; first_->entries[l] = size_ + 1;
             }
 
-            n = new NodeType(key, newHeight, std::forward<Args>(args)...); 
+            n = create(key, newHeight, std::forward<Args>(args)...);
             inserted_.push_back(n);
 
             for(int l = 0; l < newHeight; ++l) {
@@ -276,14 +303,14 @@ namespace imp {
             } while(it != last);
         }
         
-        static void multiply_impl(AccessType const begin, int const level, int const sec, Matrix<Mode, Value> const** const mat, Vector<Mode> const** const prop, Matrix<Mode, Value>* A, Matrix<Mode, Value>* B, itf::Batcher<Value>& batcher) {
+        void multiply_impl(AccessType const begin, int const level, int const sec, Matrix<Mode, Value> const** const mat, Vector<Mode> const** const prop, Matrix<Mode, Value>* A, Matrix<Mode, Value>* B, Memory& memory, itf::Batcher<Value>& batcher) {
             auto const end = begin.next(level);
             auto l = level; while(begin.next(l) == end) --l;
 
             auto s = sec; auto m = mat; auto p = prop;
             for(auto it = begin; it != end; it = it.next(l))
                 if(it.next(l) != it.next(0)) {
-                    if(!it->op(l)->isMat(s)) multiply_impl(it, l, s, m, p, A, B, batcher);
+                    if(!it->op(l)->isMat(s)) multiply_impl(it, l, s, m, p, A, B, memory, batcher);
                     *m++ = &it->op(l)->mat(s); s = it->op(l)->map(s).sector; *p++ = nullptr;
                 } else {
                     *m++ = &it->op0->mat(s); s = it->op0->map(s).sector; *p++ = &it->prop()->at(s);
@@ -295,12 +322,11 @@ namespace imp {
                 *m = A; std::swap(A, B);
             }
             while(*(++m + 1) != nullptr) {
-                mult(*A, **m, **(m - 1), batcher);
-                if(*++p != nullptr) evolveL(**p, *A, batcher);
+                if(*++p != nullptr) multEvolveL(*A, **p, **m, **(m - 1), batcher); else mult(*A, **m, **(m - 1), batcher);
                 *m = A; std::swap(A, B);
             }
-            mult(begin->op(level)->mat(sec, (*m)->I()*(*(m - 1))->J()), **m, **(m - 1), batcher);
-            if(*++p != nullptr) evolveL(**p, begin->op(level)->mat(sec), batcher);
+            auto& dest = begin->op(level)->mat(sec, eig_.at(s).dim()*eig_.at(sec).dim(), memory);  // the dimensions of the buffers are not set yet if the batcher records
+            if(*++p != nullptr) multEvolveL(dest, **p, **m, **(m - 1), batcher); else mult(dest, **m, **(m - 1), batcher);
             
             auto& map = begin->op(level)->set_map(sec);
             map.sector = s; norm(&map.norm, begin->op(level)->mat(sec), batcher);
@@ -0,0 +1,156 @@
+#ifndef CTQMC_INCLUDE_IMPURITY_PRUNING_H
+#define CTQMC_INCLUDE_IMPURITY_PRUNING_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include "Algebra.h"
+#include "Product.h"
+#include "DensityMatrix.h"
+#include "../Utilities.h"
+#include "../../../include/JsonX.h"
+#include "../../../include/io/Vector.h"
+
+//Adaptive pruning of sectors ("prune sectors" : p), per Markov chain.
+//
+//The density matrix only takes the active sectors as sectors at tau = 0, so the others cost neither bounds nor products. During the
+//thermalisation the sector probabilities are accumulated as in obs::partition::SectorProb, i.e. along the whole imaginary time
+//interval, which also covers the dropped sectors. Every "prune interval" steps the least probable sectors are dropped, as many as
+//possible such that their total probability over this interval stays below p, and the others are active (again). The sector with the
+//largest weight in the current configuration is never dropped, such that its trace does not vanish. The weight of the configurations
+//changes with the active sectors, so the density matrix and the sign have to be computed anew after each change (c.f.
+//mch::Phase::Prune), and the active sectors are fixed in the measurement phase. The operators and eigenvalues are shared and left
+//as they are.
+
+namespace imp {
+
+    struct Pruning {
+        Pruning() = delete;
+        Pruning(jsx::value const& jParams, itf::EigenValues const& eig) :
+        threshold_(jParams.is("prune sectors") ? jParams("prune sectors").real64() : .0),
+        interval_(jParams.is("prune interval") ? jParams("prune interval").int64() : 1000),
+        active_(eig.sectorNumber() + 1, 1), acc_(eig.sectorNumber() + 1, .0),
+        samples_(0), steps_(0), reactivated_(0), dropped_(.0) {
+            if(interval_ < 1) throw std::runtime_error("imp::Pruning: invalid prune interval");
+            active_[0] = 0; update();
+        };
+        Pruning(Pruning const&) = delete;
+        Pruning(Pruning&&) = delete;
+        Pruning& operator=(Pruning const&) = delete;
+        Pruning& operator=(Pruning&&) = delete;
+        ~Pruning() = default;
+
+        bool enabled() const { return threshold_ > .0;};
+
+        std::vector<int> const& sectors() const { return sectors_;};
+        int pruned() const { return active_.size() - 1 - sectors_.size();};
+        std::int64_t reactivated() const { return reactivated_;};
+        double dropped() const { return dropped_;};  // probability of the dropped sectors at the last pruning
+
+        //After each step of the Markov chain in the thermalisation, returns true if the active sectors changed
+        template<typename Mode, typename Value>
+        bool step(itf::Product<Value>& product, itf::DensityMatrix<Value> const& densityMatrix) {
+            if(!enabled()) return false;
+
+            sample(get<Mode>(product), densityMatrix);
+
+            if(++steps_%interval_) return false;
+
+            return prune(densityMatrix);
+        };
+
+        //Active sectors and reactivations, c.f. checkpoints. The accumulated weights are not kept, they start over.
+        jsx::value json() const {
+            return jsx::object_t{
+                { "active", io::ivec(active_.begin(), active_.end()) },
+                { "steps", steps_ }, { "reactivated", reactivated_ }, { "dropped", dropped_ }
+            };
+        };
+
+        void restore(jsx::value const& jPruning) {
+            auto const& active = jsx::at<io::ivec>(jPruning("active"));
+            if(active.size() != active_.size()) throw std::runtime_error("imp::Pruning::restore: wrong number of sectors");
+
+            std::copy(active.begin(), active.end(), active_.begin());
+            steps_ = jPruning("steps").int64(); reactivated_ = jPruning("reactivated").int64();
+            dropped_ = jPruning.is("dropped") ? jPruning("dropped").real64() : .0;
+            update();
+        };
+
+    private:
+        double const threshold_;
+        std::int64_t const interval_;
+
+        std::vector<int> active_, sectors_;
+        std::vector<double> acc_;
+        std::int64_t samples_, steps_, reactivated_;
+        double dropped_;
+
+        void update() {
+            sectors_.clear();
+            for(int s = 1; s < static_cast<int>(active_.size()); ++s) if(active_[s]) sectors_.push_back(s);
+        };
+
+        //c.f. obs::partition::SectorProb
+        template<typename Mode, typename Value>
+        void sample(Product<Mode, Value>& product, itf::DensityMatrix<Value> const& densityMatrix) {
+            std::vector<std::pair<int, int>> sector;  for(auto s : densityMatrix) sector.push_back(std::make_pair(s, s));
+
+            double prev = .0;
+            for(auto n = product.first().next(0); n != product.last(); n = n.next(0)) {
+                double const present = n.key()/static_cast<double>(ut::KeyMax);
+                
+                for(auto& s : sector) {
+                    acc_[s.second] += std::abs(densityMatrix.weight(s.first))*(present - prev);
+                    s.second = n->op0->map(s.second).sector;
+                }
+                prev = present;
+            }
+
+            for(auto s : sector) acc_[s.second] += std::abs(densityMatrix.weight(s.first))*(1. - prev);
+
+            ++samples_;
+        };
+        
+        //Drops the sectors from the least probable one up while their total probability stays below the threshold
+        template<typename Value>
+        bool prune(itf::DensityMatrix<Value> const& densityMatrix) {
+            std::vector<int> const previous = active_;
+
+            double const total = std::accumulate(acc_.begin() + 1, acc_.end(), .0);
+            
+            if(total > .0) {
+                int keep = 0; double max = -1.;
+                for(auto s : densityMatrix)
+                    if(std::abs(densityMatrix.weight(s)) > max) { max = std::abs(densityMatrix.weight(s)); keep = s;}
+                
+                std::vector<int> order;
+                for(int s = 1; s < static_cast<int>(acc_.size()); ++s) if(s != keep) order.push_back(s);
+                std::sort(order.begin(), order.end(), [&](int lhs, int rhs) { return acc_[lhs] < acc_[rhs];});
+                
+                double dropped = .0; std::size_t n = 0;
+                for(; n < order.size() && dropped + acc_[order[n]] < threshold_*total; ++n) dropped += acc_[order[n]];
+                
+                std::vector<int> active(acc_.size(), 1); active[0] = 0;
+                for(std::size_t i = 0; i < n; ++i) active[order[i]] = 0;
+                
+                for(std::size_t s = 1; s < acc_.size(); ++s) if(!active_[s] && active[s]) ++reactivated_;
+                
+                active_ = std::move(active); dropped_ = dropped/total;
+            }
+
+            std::fill(acc_.begin(), acc_.end(), .0); samples_ = 0;
+            update();
+
+            return active_ != previous;
+        };
+    };
+
+}
+
+#endif
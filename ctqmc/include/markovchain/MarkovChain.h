@@ -35,7 +35,11 @@ namespace mch {
         MarkovChain() = delete;
         template<typename Mode>
         MarkovChain(jsx::value const& jParams, std::int64_t ID, Mode) :
-        clean_(jParams.is("clean") ? jParams("clean").int64() : 10000), steps_(0),
+        id_(ID),
+        clean_(jParams.is("clean") ? jParams("clean").int64() : 10000),
+        cleanDrift_(jParams.is("clean drift") ? jParams("clean drift").real64() : 1.e-8),
+        cleanCheck_(jParams.is("clean check") ? jParams("clean check").int64() : 100),
+        cleanInterval_(clean_), cleanStep_(clean_), steps_(0),
         init_(new state::Init<Mode, Value>()),
         urng_(ut::Engine(select_seed(jParams,ID)), ut::UniformDistribution(.0, 1.)),
         update_(nullptr) {
@@ -47,6 +51,8 @@ namespace mch {
         ~MarkovChain() = default;
         
         
+        std::int64_t id() const { return id_;};
+        
         void add(std::unique_ptr<itf::Update<Value>> update) {
             if(update->origin() != update->target())
                 throw std::runtime_error("mc::MarkovChain::add");
@@ -80,13 +86,41 @@ namespace mch {
         bool cycle(mch::WangLandau<Value>& wangLandau,  data::Data<Value> const& data, state::State<Value>& state, imp::itf::Batcher<Value>& batcher) {
             if(!update_->apply(urn_, wangLandau, data, state, urng_, batcher)) return false;
             
-            choose_update(state); if(++steps_ % clean_ == 0) state.clean(data);
+            choose_update(state); ++steps_;
+            
+            if(steps_ == cleanStep_ || (cleanDrift_ > .0 && cleanCheck_ > 0 && steps_ % cleanCheck_ == 0 && state.residual(data, steps_/cleanCheck_) > cleanDrift_))
+                clean(data, state);
             
             return true;
         };
         
+        //random number generator, next update and clean schedule, c.f. checkpoints
+        jsx::value json() const {
+            jsx::value jUpdate;
+            for(std::size_t space = 0; space < allUpdates_.size(); ++space)
+                for(std::size_t update = 0; update < allUpdates_[space].size(); ++update)
+                    if(allUpdates_[space][update].get() == update_) jUpdate = jsx::array_t{ static_cast<std::int64_t>(space), static_cast<std::int64_t>(update) };
+            
+            return jsx::object_t{
+                {"rng", urng_.state()}, {"update", std::move(jUpdate)}, {"urn", urn_},
+                {"steps", steps_}, {"clean interval", cleanInterval_}, {"clean step", cleanStep_}
+            };
+        };
+        
+        //After finalize, which already chose an update with the random number generator not yet restored
+        void restore(jsx::value const& jMarkovChain) {
+            urng_.state(jMarkovChain("rng").string());
+            update_ = allUpdates_.at(jMarkovChain("update")(0).int64()).at(jMarkovChain("update")(1).int64()).get(); urn_ = jMarkovChain("urn").real64();
+            steps_ = jMarkovChain("steps").int64(); cleanInterval_ = jMarkovChain("clean interval").int64(); cleanStep_ = jMarkovChain("clean step").int64();
+        };
+        
     private:
+        std::int64_t const id_;
         std::int64_t const clean_;
+        double const cleanDrift_;
+        std::int64_t const cleanCheck_;
+        std::int64_t cleanInterval_;
+        std::int64_t cleanStep_;
         std::int64_t steps_;
         double urn_;
         
@@ -117,6 +151,21 @@ namespace mch {
             urn_ = (urn - low)/(*it - low);
             update_ = updates[it - distr.begin()].get();
         };
+        
+        //The interval adapts to the drift of the fast updates ("clean drift", 0 keeps it fixed), bounded by 100 times "clean". Every "clean check"
+        //steps the residual of one column is checked in O(N^2), and if it exceeds "clean drift" the matrices are recomputed right away.
+        void clean(data::Data<Value> const& data, state::State<Value>& state) {
+            double const drift = state.clean(data);
+            
+            if(cleanDrift_ > .0) {
+                if(drift > cleanDrift_)
+                    cleanInterval_ = std::max<std::int64_t>(cleanInterval_/2, 1);
+                else if(16.*drift < cleanDrift_)
+                    cleanInterval_ = std::min<std::int64_t>(2*cleanInterval_, 100*clean_);
+            }
+            
+            cleanStep_ = steps_ + cleanInterval_;
+        };
     };
     
 }
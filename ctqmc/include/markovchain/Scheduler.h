@@ -6,56 +6,113 @@
 #include <ctime>
 #include <tuple>
 #include <random>
+#include <algorithm>
+#include <stdexcept>
 
+#include "../../../include/measurements/Binning.h"
 
 namespace mch {
     
-    enum class Phase { Initialize, Step, Sample, Finalize };
+    enum class Phase { Initialize, Step, Sample, Prune, Thermalised, Finalize };
     
+    //progress is the number of steps or seconds done, c.f. checkpoints
     struct Scheduler {
         Scheduler() = delete;
-        Scheduler(bool thermalised, Phase phase) : thermalised_(thermalised), phase_(phase) {};
+        Scheduler(bool thermalised, Phase phase, std::int64_t progress = 0) : thermalised_(thermalised), phase_(phase), progress_(progress) {};
         bool thermalised() const { return thermalised_;};
         Phase& phase() { return phase_;}
         virtual bool done() { return true;};
+        virtual std::int64_t progress() const { return progress_;};
         virtual ~Scheduler() = default;
     protected:
         bool const thermalised_;
         Phase phase_;
+        std::int64_t const progress_;
     };
     
     struct TimeScheduler : Scheduler {
-        TimeScheduler(std::int64_t duration, bool thermalised, Phase phase) :
+        TimeScheduler(std::int64_t duration, bool thermalised, Phase phase, std::int64_t progress = 0) :
         Scheduler(thermalised, phase),
         duration_(60.*duration),
-        start_(std::chrono::steady_clock::now()) {
+        start_(std::chrono::steady_clock::now() - std::chrono::seconds(progress)) {
         };
         ~TimeScheduler() = default;
         
         bool done() {
             return !(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_).count() < duration_);
         };
+        std::int64_t progress() const {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_).count();
+        };
     private:
         double const duration_;
         std::chrono::steady_clock::time_point const start_;
     };
     
     struct StepsScheduler : Scheduler {
-        StepsScheduler(std::int64_t stop, bool thermalised, Phase phase) :
+        StepsScheduler(std::int64_t stop, bool thermalised, Phase phase, std::int64_t progress = 0) :
         Scheduler(thermalised, phase),
         stop_(stop),
-        steps_(0) {
+        steps_(progress) {
         };
         ~StepsScheduler() = default;
         
         bool done() {
             return ++steps_ >= stop_;
         };
+        std::int64_t progress() const {
+            return steps_;
+        };
     private:
         std::int64_t const stop_;
         std::int64_t steps_;
     };
     
+    
+    //Spacing of the samples of the observables of a worm space in one Markov chain ("adaptive sweep" : n). The expansion order and the sign are binned
+    //at every step, and an observable is sampled n times per 2 tau steps (tau the larger integrated autocorrelation time of the two),
+    //but not more often than every sweep steps. Until tau is known the observables are sampled every sweep steps.
+    struct SampleScheduler {
+        SampleScheduler() = delete;
+        explicit SampleScheduler(double samples) : samples_(samples), steps_(0), tau_(-1.) {
+            if(!(samples_ > .0)) throw std::runtime_error("mch::SampleScheduler: invalid adaptive sweep");
+        };
+        SampleScheduler(SampleScheduler const&) = delete;
+        SampleScheduler(SampleScheduler&&) = delete;
+        SampleScheduler& operator=(SampleScheduler const&) = delete;
+        SampleScheduler& operator=(SampleScheduler&&) = delete;
+        ~SampleScheduler() = default;
+        
+        void add(double k, double sign) {
+            double const proxies[] = { k, sign };  bins_.add(proxies, 2, 1.);
+            
+            if(++steps_%update() == 0) tau_ = std::max(bins_.tau(0), bins_.tau(1));
+        };
+        
+        std::int64_t interval(std::int64_t sweep) const {
+            return std::max(sweep, static_cast<std::int64_t>(2.*tau_/samples_));
+        };
+        
+        double tau() const { return tau_;};
+        
+        //c.f. checkpoints
+        jsx::value json() const {
+            return jsx::object_t{{ "steps", steps_ }, { "tau", tau_ }, { "binning", bins_.json() }};
+        };
+        
+        void restore(jsx::value const& jScheduler) {
+            steps_ = jScheduler("steps").int64(); tau_ = jScheduler("tau").real64(); bins_.restore(jScheduler("binning"), 2);
+        };
+        
+    private:
+        double const samples_;
+        std::int64_t steps_;
+        double tau_;
+        meas::Binning<double> bins_;
+        
+        static std::int64_t update() { return 256;};
+    };
+    
 }
 
 
@@ -5,6 +5,7 @@
 #include "../Data.h"
 #include "../config/Worms.h"
 #include "../../../include/JsonX.h"
+#include "../../../include/io/Vector.h"
 
 namespace mch {
     
@@ -48,33 +49,61 @@ namespace mch {
         ~WangLandau() = default;
         
         void thermalised() {
-            if(!thermalised_) {
-                if (!restart_){
-                    normalise_eta();  steps_.fill(0);
-                }
+            thermalised(std::vector<WangLandau*>{this});
+        };
+        
+        //Fixes the eta's of all Markov chains of this process to the average over all chains of all processes
+        static void thermalised(std::vector<WangLandau*> const& wangLandaus) {
+            auto& front = *wangLandaus.front();
+            
+            if(!front.thermalised_) {
+                for(auto wangLandau : wangLandaus)
+                    if (!wangLandau->restart_){
+                        wangLandau->normalise_eta();  wangLandau->steps_.fill(0);
+                    }
                 
                 //All mp images should have the same eta
-                for(auto active : active_) {
-                    mpi::reduce<mpi::op::sum>(eta_[active], mpi::master);
+                std::int64_t chains = wangLandaus.size();
+                mpi::all_reduce<mpi::op::sum>(chains);
+                
+                for(auto active : front.active_) {
+                    double eta = .0;
+                    for(auto wangLandau : wangLandaus) eta += wangLandau->eta_[active];
+                    
+                    mpi::reduce<mpi::op::sum>(eta, mpi::master);
                 
                     if(mpi::rank() == mpi::master)
-                        eta_[active] = eta_[active]/mpi::number_of_workers();
+                        eta = eta/chains;
                 
-                    mpi::bcast(eta_[active], mpi::master);
+                    mpi::bcast(eta, mpi::master);
+                    
+                    front.eta_[active] = eta;
                 }
             
                 //Let user know what eta's were chosen
-                double const partition = eta_[get_index<cfg::partition::Worm>::value];
-                for(auto active : active_) {
-                    eta_[active] /= partition;  // Tradition ...
+                double const partition = front.eta_[get_index<cfg::partition::Worm>::value];
+                for(auto active : front.active_) {
+                    front.eta_[active] /= partition;  // Tradition ...
                 
-                    mpi::cout << names_[active] << " eta = " << eta_[active] << std::endl;
+                    mpi::cout << front.names_[active] << " eta = " << front.eta_[active] << std::endl;
                 }
 
-                thermalised_ = true;
+                for(auto wangLandau : wangLandaus) {
+                    wangLandau->eta_ = front.eta_;  wangLandau->thermalised_ = true;
+                }
             }
         };
         
+        bool is_thermalised() const {
+            return thermalised_;
+        };
+        
+        //Markov chains running in parallel on the same process share the eta's, but count their steps separately
+        void add(WangLandau const& other) {
+            for(auto active : active_) steps_[active] += other.steps_[active];
+            totalSteps_ += other.totalSteps_;
+        };
+        
         template<typename W>
         double eta(W const& w) const {
             return eta_[get_index<W>::value];
@@ -122,6 +151,22 @@ namespace mch {
             }
         };
         
+        //etas and histogram, c.f. checkpoints
+        jsx::value json() const {
+            return jsx::object_t{
+                {"eta", io::rvec(eta_.begin(), eta_.end())}, {"steps", io::ivec(steps_.begin(), steps_.end())},
+                {"total steps", totalSteps_}, {"lambda", lambda_}, {"thermalised", thermalised_}
+            };
+        };
+        
+        void restore(jsx::value const& jWangLandau) {
+            auto const& eta = jsx::at<io::rvec>(jWangLandau("eta")); auto const& steps = jsx::at<io::ivec>(jWangLandau("steps"));
+            if(eta.size() != eta_.size() || steps.size() != steps_.size()) throw std::runtime_error("mch::WangLandau::restore: invalid format");
+            
+            std::copy(eta.begin(), eta.end(), eta_.begin()); std::copy(steps.begin(), steps.end(), steps_.begin());
+            totalSteps_ = jWangLandau("total steps").int64(); lambda_ = jWangLandau("lambda").real64(); thermalised_ = jWangLandau("thermalised").boolean();
+        };
+        
         jsx::value etas() {
             jsx::value jEtas;
             
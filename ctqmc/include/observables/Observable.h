@@ -14,6 +14,9 @@ namespace obs {
         struct Observable {
             virtual bool sample(Value const sign, data::Data<Value> const& data, state::State<Value>& state, jsx::value& measurements, imp::itf::Batcher<Value>& batcher) = 0;
             virtual void finalize(data::Data<Value> const& data, jsx::value& measurements) = 0;
+            virtual void flush(data::Data<Value> const& data, jsx::value& measurements) = 0;  // stores the samples since the last store (no mpi), c.f. checkpoints
+            virtual jsx::value json() const { return jsx::null_t();};                         // state which outlives a flush, c.f. checkpoints
+            virtual void restore(jsx::value const& jObservable) {};
             virtual ~Observable() = default;
         };
         
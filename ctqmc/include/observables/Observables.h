@@ -2,18 +2,26 @@
 #define CTQMC_INCLUDE_OBSERVABLES_OBSERVABLES_H
 
 #include <vector>
+#include <map>
 
 #include "Observable.h"
 #include "../Data.h"
 #include "../State.h"
+#include "../markovchain/Scheduler.h"
+#include "../../../include/io/Vector.h"
 
 namespace obs {
 
+    //With "adaptive sweep" the observables are sampled at intervals adapted to the autocorrelation time, c.f. mch::SampleScheduler. The Markov
+    //chains sharing the observables (round-robin on one thread) are different time series, so each has its own scheduler and counts its own steps.
     template<typename Value>
     struct WormObservables {
         WormObservables() = delete;
-        WormObservables(std::string worm) :
-        worm_(worm), steps_(0), it_(obs_.end()) {
+        WormObservables(std::string worm, jsx::value const& jParams) :
+        worm_(worm), steps_(0),
+        adaptive_(jParams.is("adaptive sweep") ? jParams("adaptive sweep").real64() : .0),
+        it_(obs_.end()) {
+            if(jParams.is("adaptive sweep") && !adaptive()) throw std::runtime_error("obs::WormObservables: invalid adaptive sweep");
         }
         WormObservables(WormObservables const&) = delete;
         WormObservables(WormObservables&&) = default;
@@ -24,33 +32,47 @@ namespace obs {
         
         template<typename T, typename... Args>
         void add(std::int64_t sweep, std::int64_t store, Args&&... args) {
-            obs_.emplace_back(sweep, obs_pointer(new T(store, std::forward<Args>(args)...)));
+            obs_.push_back(Entry{ sweep, sweep, 0, false, obs_pointer(new T(store, std::forward<Args>(args)...)) });
             
             it_ = obs_.end();
         };
         
-        bool sample(data::Data<Value> const& data, state::State<Value>& state) {
+        bool sample(data::Data<Value> const& data, state::State<Value>& state, std::int64_t chain) {
             if(it_ != obs_.end()) return false;
             
             ++steps_;
             
-            for(auto const& obs : obs_)
-                if(steps_%obs.first == 0)
-                {
-                    sign_ = state.sign();
-                    it_   = obs_.begin();
-                    
-                    return true;
-                }
+            bool due = false;
+            if(adaptive()) {
+                auto& ch = get(chain);
+                
+                ++ch.steps; ch.scheduler->add(state.product().size()/2, ut::real(state.sign()));
+                
+                for(std::size_t i = 0; i < obs_.size(); ++i)
+                    if((obs_[i].due = !(ch.steps < ch.next[i]))) {
+                        ch.next[i] = ch.steps + ch.scheduler->interval(obs_[i].sweep);
+                        ++obs_[i].samples; due = true;
+                    }
+            } else
+                for(auto& obs : obs_)
+                    if((obs.due = !(steps_ < obs.next))) {
+                        obs.next = steps_ + obs.sweep;
+                        ++obs.samples; due = true;
+                    }
             
-            return false;
+            if(due) {
+                sign_ = state.sign();
+                it_   = obs_.begin();
+            }
+            
+            return due;
         }
         
         bool cycle(data::Data<Value> const& data, state::State<Value>& state, jsx::value& measurements, imp::itf::Batcher<Value>& batcher) {
             while(it_ != obs_.end())
             {
-                if(steps_%it_->first == 0)
-                    if(!it_->second->sample(sign_, data, state, measurements[worm_], batcher))
+                if(it_->due)
+                    if(!it_->obs->sample(sign_, data, state, measurements[worm_], batcher))
                         return false;
 
                 ++it_;
@@ -61,18 +83,103 @@ namespace obs {
         
         void finalize(data::Data<Value> const& data, jsx::value& measurements) {
             for(auto& obs : obs_)
-                obs.second->finalize(data, measurements[worm_]);
+                obs.obs->finalize(data, measurements[worm_]);
+        };
+        
+        //Stores the samples taken since the last store, such that the measurements of a checkpoint are complete
+        void flush(data::Data<Value> const& data, jsx::value& measurements) {
+            for(auto& obs : obs_)
+                obs.obs->flush(data, measurements[worm_]);
+        };
+        
+        //Sampling schedule and state of the observables, c.f. checkpoints
+        jsx::value json() const {
+            io::ivec next, samples; jsx::array_t jObs;
+            for(auto const& obs : obs_) {
+                next.push_back(obs.next); samples.push_back(obs.samples); jObs.push_back(obs.obs->json());
+            }
+            
+            jsx::value jChains = jsx::object_t();
+            for(auto const& ch : chains_)
+                jChains[std::to_string(ch.first)] = jsx::object_t{
+                    { "steps", ch.second.steps }, { "next", io::ivec(ch.second.next.begin(), ch.second.next.end()) }, { "scheduler", ch.second.scheduler->json() }
+                };
+            
+            return jsx::object_t{
+                { "steps", steps_ }, { "next", std::move(next) }, { "samples", std::move(samples) }, { "observables", std::move(jObs) }, { "chains", std::move(jChains) }
+            };
+        };
+        
+        void restore(jsx::value const& jWormObservables) {
+            auto const& next = jsx::at<io::ivec>(jWormObservables("next")); auto const& samples = jsx::at<io::ivec>(jWormObservables("samples"));
+            if(next.size() != obs_.size()) throw std::runtime_error("obs::WormObservables::restore: wrong number of observables");
+            
+            steps_ = jWormObservables("steps").int64();
+            for(std::size_t i = 0; i < obs_.size(); ++i) {
+                obs_[i].next = next[i]; obs_[i].samples = samples[i]; obs_[i].obs->restore(jWormObservables("observables")(i));
+            }
+            
+            for(auto const& jChain : jWormObservables("chains").object()) {
+                auto& ch = get(std::stoll(jChain.first)); auto const& next = jsx::at<io::ivec>(jChain.second("next"));
+                ch.steps = jChain.second("steps").int64(); std::copy(next.begin(), next.end(), ch.next.begin());
+                ch.scheduler->restore(jChain.second("scheduler"));
+            }
+        };
+        
+        bool adaptive() const { return adaptive_ > .0;};
+        
+        //Sum of the autocorrelation times of the Markov chains for which it is known, and their number
+        double tau() const {
+            double tau = .0; for(auto const& ch : chains_) if(ch.second.scheduler->tau() >= .0) tau += ch.second.scheduler->tau(); return tau;
+        };
+        std::int64_t chains() const {
+            std::int64_t chains = 0; for(auto const& ch : chains_) if(ch.second.scheduler->tau() >= .0) ++chains; return chains;
+        };
+        
+        //Samples taken, and samples the fixed sweeps would have taken in addition
+        std::int64_t samples() const {
+            std::int64_t samples = 0; for(auto const& obs : obs_) samples += obs.samples; return samples;
+        };
+        std::int64_t skipped() const {
+            std::int64_t skipped = 0;
+            for(auto const& obs : obs_) {
+                if(adaptive()) for(auto const& ch : chains_) skipped += ch.second.steps/obs.sweep; else skipped += steps_/obs.sweep;
+                skipped -= obs.samples;
+            }
+            return skipped;
         };
         
     private:
         using obs_pointer = std::unique_ptr<itf::Observable<Value>>;
         
+        struct Entry {
+            std::int64_t sweep, next, samples; bool due;
+            obs_pointer obs;
+        };
+        
+        struct Chain {
+            std::int64_t steps;
+            std::vector<std::int64_t> next;
+            std::unique_ptr<mch::SampleScheduler> scheduler;
+        };
+        
         std::string  const worm_;
         std::int64_t steps_;
+        double const adaptive_;
+        std::map<std::int64_t, Chain> chains_;  // by id of the Markov chain, only with "adaptive sweep"
         
         Value sign_;
-        std::vector<std::pair<std::int64_t, obs_pointer>> obs_;
-        typename std::vector<std::pair<std::int64_t, obs_pointer>>::iterator it_;
+        std::vector<Entry> obs_;
+        typename std::vector<Entry>::iterator it_;
+        
+        Chain& get(std::int64_t chain) {
+            auto it = chains_.find(chain);
+            if(it == chains_.end()) {
+                std::vector<std::int64_t> next; for(auto const& obs : obs_) next.push_back(obs.sweep);
+                it = chains_.emplace(chain, Chain{ 0, std::move(next), std::unique_ptr<mch::SampleScheduler>(new mch::SampleScheduler(adaptive_)) }).first;
+            }
+            return it->second;
+        };
     };
     
     
@@ -80,6 +80,13 @@ namespace obs {
                 if(Density) densityMatrix_->store(data, measurements["density matrix"], samples_);
             };
             
+            void flush(data::Data<Value> const& data, jsx::value& measurements) {
+                if(Density) {
+                    densityMatrix_->store(data, measurements["density matrix"], samples_); densityMatrix_->clear(data);
+                }
+                samples_ = 0;
+            };
+            
         private:
             
             enum class Phase { Prepare, Calculate };
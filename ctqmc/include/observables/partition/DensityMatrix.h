@@ -17,11 +17,7 @@ namespace obs {
         struct DensityMatrix {
             DensityMatrix() = delete;
             DensityMatrix(jsx::value const& jParams, data::Data<Value> const& data) {
-                auto const& eig = imp::get<Mode>(data.eig());
-                
-                data_.resize(eig.sectorNumber() + 1);
-                for(int sec = eig.sectorNumber(); sec; --sec)
-                    data_[sec].reset(new imp::Matrix<Mode, Value>(typename imp::Matrix<Mode, Value>::Zero(eig.at(sec).dim())));
+                clear(data);
             };
             DensityMatrix(DensityMatrix const&) = delete;
             DensityMatrix(DensityMatrix&&) = delete;
@@ -33,6 +29,14 @@ namespace obs {
                 return *data_[sec];
             };
             
+            void clear(data::Data<Value> const& data) {
+                auto const& eig = imp::get<Mode>(data.eig());
+                
+                data_.resize(eig.sectorNumber() + 1);
+                for(int sec = eig.sectorNumber(); sec; --sec)
+                    data_[sec].reset(new imp::Matrix<Mode, Value>(typename imp::Matrix<Mode, Value>::Zero(eig.at(sec).dim())));
+            };
+            
             void store(data::Data<Value> const& data, jsx::value& measurements, std::int64_t samples) {
                 if(!measurements.is<jsx::array_t>())
                     measurements = jsx::array_t(data.eig().sectorNumber());
@@ -95,6 +99,11 @@ namespace obs {
                 accDensityMatrix_.store(data, measurements["density matrix"], samples_);
             };
             
+            void flush(data::Data<Value> const& data, jsx::value& measurements) {
+                accDensityMatrix_.store(data, measurements["density matrix"], samples_); accDensityMatrix_.clear(data);
+                samples_ = 0;
+            };
+            
         private:
             enum class Phase { Sample, Finalize };
             
@@ -154,11 +163,18 @@ namespace obs {
             }
             
             void finalize(data::Data<Value> const& data, jsx::value& measurements) {
+                flush(data, measurements);
+            };
+            
+            void flush(data::Data<Value> const& data, jsx::value& measurements) {
                 store(data, measurements);
                 
-                measurements["density matrix dyn"] = jsx::array_t(data.dyn()->size());
-                for(int qn = 0; qn < data.dyn()->size(); ++qn)
-                    accDensityMatrices_[qn]->store(data, measurements["density matrix dyn"][qn], samples0_);
+                if(!measurements["density matrix dyn"].is<jsx::array_t>()) measurements["density matrix dyn"] = jsx::array_t(data.dyn()->size());
+                for(int qn = 0; qn < data.dyn()->size(); ++qn) {
+                    accDensityMatrices_[qn]->store(data, measurements["density matrix dyn"][qn], samples0_); accDensityMatrices_[qn]->clear(data);
+                }
+                
+                samples0_ = 0;
             };
             
         private:
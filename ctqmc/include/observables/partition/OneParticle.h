@@ -60,10 +60,12 @@ namespace obs {
             
             bool sample(Value const sign, data::Data<Value> const& data, state::State<Value>& state, jsx::value& measurements, imp::itf::Batcher<Value>& batcher) {
                 for(auto const& bath : state.baths()) {
-                    auto data = bath.B().data();
-                    for(auto const& opL : bath.opsL())
+                    int l = 0;
+                    for(auto const& opL : bath.opsL()) {
+                        auto data = bath.B().data(0, l++);
                         for(auto const& opR : bath.opsR())
                             matrix_[opR.flavor() + flavors_*opL.flavor()]->add(opR.key() - opL.key(), sign*Select::get(*data++ , opL.bulla(), opR.bulla()));
+                    }
                 }
                 
                 ++samples_; if(samples_%store_ == 0) store(data, measurements);
@@ -75,6 +77,10 @@ namespace obs {
                 store(data, measurements);
             };
             
+            void flush(data::Data<Value> const& data, jsx::value& measurements) {
+                store(data, measurements);
+            };
+            
         private:
             int const flavors_;
             
@@ -56,6 +56,10 @@ namespace obs {
                 store(data, measurements);
             };
             
+            void flush(data::Data<Value> const& data, jsx::value& measurements) {
+                store(data, measurements);
+            };
+            
         private:
             std::int64_t const store_;
             std::int64_t samples_;
@@ -104,11 +104,11 @@ namespace obs {
         
         if(jPartition("occupation susceptibility bulla").boolean()) {
             auto& bullaOcc = data.template opt<imp::itf::BullaOccupation<Value>>();
-            bullaOcc.reset(new imp::BullaOccupation<Mode, Value>(jParams, data.filling(), jParams("hloc")("eigen values"), jParams("operators"), data.eig()));
+            if(bullaOcc.get() == nullptr) bullaOcc.reset(new imp::BullaOccupation<Mode, Value>(jParams, data.filling(), jParams("hloc")("eigen values"), jParams("operators"), data.eig()));
         }
         
         
-        observables.reset(new WormObservables<Value>(cfg::partition::Worm::name()));
+        observables.reset(new WormObservables<Value>(cfg::partition::Worm::name(), jParams));
 
         
         partition::setup_obsA<Mode>(jParams, data, *observables);
@@ -80,6 +80,10 @@ namespace obs {
                 store(data, measurements);
             };
             
+            void flush(data::Data<Value> const& data, jsx::value& measurements) {
+                store(data, measurements);
+            };
+            
         private:
             int const flavors_;
             std::size_t const nMat_;
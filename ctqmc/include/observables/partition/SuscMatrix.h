@@ -57,6 +57,10 @@ namespace obs {
                 store(data, measurements);
             };
             
+            void flush(data::Data<Value> const& data, jsx::value& measurements) {
+                store(data, measurements);
+            };
+            
         private:
             
             enum class Phase { Calculate, Finalize };
@@ -2,7 +2,9 @@
 #define CTQMC_INCLUDE_OBSERVABLES_WORM_BASIS_H
 
 #include "Function.h"
+#include "Nfft.h"
 #include "../../Data.h"
+#include "../../../../include/BlasLapack.h"
 
 
 namespace obs {
@@ -22,9 +24,34 @@ namespace obs {
             using type = Value;
         };
         
+        template<typename Value>
+        struct data_trait<FuncType::Nfft, Value> {
+            using type = ut::complex;
+        };
+        
         template<FuncType funcType, typename Value> using data_trait_t = typename data_trait<funcType, Value>::type;
         
         
+        //data[i] += fact*x[i], with the complex product written out such that the loop vectorizes (std::complex multiplication goes through __muldc3)
+        inline void accumulate(ut::complex const fact, ut::complex const* x, ut::complex* data, std::size_t const size) {
+            double const re = fact.real(), im = fact.imag();
+            double const* in = reinterpret_cast<double const*>(x); double* out = reinterpret_cast<double*>(data);
+            for(std::size_t i = 0; i < size; ++i) {
+                out[2*i]     += re*in[2*i] - im*in[2*i + 1];
+                out[2*i + 1] += re*in[2*i + 1] + im*in[2*i];
+            }
+        };
+        
+        inline void accumulate(ut::complex const fact, double const* x, ut::complex* data, std::size_t const size) {
+            double const re = fact.real(), im = fact.imag();
+            double* out = reinterpret_cast<double*>(data);
+            for(std::size_t i = 0; i < size; ++i) {
+                out[2*i]     += re*x[i];
+                out[2*i + 1] += im*x[i];
+            }
+        };
+        
+        
         
         
         template<typename, FuncType, typename...> struct Basis;
@@ -64,10 +91,13 @@ namespace obs {
         };
         
         
+        //With "buffer" K > 0 the samples are collected, and added with one matrix product data_ += fermion12 x (sign boson32 fermion34)^T once K are there
         template<typename Value, FuncType funcType>
         struct Basis<Value, funcType, cfg::FermionicTime, cfg::FermionicTime, cfg::FermionicTime, cfg::FermionicTime> {
             
             void store(jsx::value& measurements, std::int64_t samples) {
+                flush();
+                
                 measurements << meas::fix(data_, samples);
                 
                 std::fill(data_.begin(), data_.end(), .0);
@@ -79,7 +109,11 @@ namespace obs {
             boson32_(jWorm("boson cutoff").int64()),
             fermion12_(jWorm("fermion cutoff").int64()),
             fermion34_(jWorm("fermion cutoff").int64()),
-            data_(fermion12_().size()*fermion34_().size()*boson32_().size(), .0) {
+            data_(fermion12_().size()*fermion34_().size()*boson32_().size(), .0),
+            buffer_(jWorm.is("buffer") ? jWorm("buffer").int64() : 0),
+            buffered_(0),
+            left_(buffer_*fermion12_().size()),
+            right_(buffer_*fermion34_().size()*boson32_().size()) {
             };
             Basis(Basis const&) = delete;
             Basis(Basis&&) = default;
@@ -92,11 +126,24 @@ namespace obs {
                 fermion34_(op3.key() - op4.key());
                 boson32_(op2.key() - op3.key());
                 
-                auto data = data_.data();
-                for(auto b32 : boson32_())
-                    for(auto f34 : fermion34_())
-                        for(auto f12 : fermion12_())
-                            *data++ += sign*f12*f34*b32;
+                auto const& f12 = fermion12_();
+                
+                if(buffer_) {
+                    std::copy(f12.begin(), f12.end(), left_.begin() + buffered_*f12.size());
+                    
+                    auto right = right_.begin() + buffered_*fermion34_().size()*boson32_().size();
+                    for(auto b32 : boson32_())
+                        for(auto f34 : fermion34_())
+                            *right++ = sign*b32*f34;
+                    
+                    if(++buffered_ == buffer_) flush();
+                } else {
+                    auto data = data_.data();
+                    for(auto b32 : boson32_())
+                        for(auto f34 : fermion34_()) {
+                            accumulate(sign*b32*f34, f12.data(), data, f12.size()); data += f12.size();
+                        }
+                }
             };
             
             Function<FuncType::Matsubara,   PartType::Boson,       Value> boson32_;
@@ -104,6 +151,22 @@ namespace obs {
             Function<           funcType, PartType::Fermion, ut::complex> fermion34_;
 
             std::vector<ut::complex> data_;   // always complex
+            
+        private:
+            std::size_t const buffer_;
+            std::size_t buffered_;
+            std::vector<ut::complex> left_;
+            std::vector<ut::complex> right_;
+            
+            void flush() {
+                if(!buffered_) return;
+                
+                char const no = 'n', yes = 't'; ut::complex const one = 1.;
+                int const rows = fermion12_().size(), cols = fermion34_().size()*boson32_().size(), inner = buffered_;
+                gemm(&no, &yes, &rows, &cols, &inner, &one, left_.data(), &rows, right_.data(), &cols, &one, data_.data(), &rows);
+                
+                buffered_ = 0;
+            };
         };
         
         
@@ -168,10 +231,12 @@ namespace obs {
                 fermion_(op1.key() - op2.key());
                 boson_(op2.key() - op3.key());
                 
+                auto const& f = fermion_();
+                
                 auto data = data_.data();
-                for(auto b : boson_())
-                    for(auto f : fermion_())
-                        *data++ += sign*f*b;
+                for(auto b : boson_()) {
+                    accumulate(sign*b, f.data(), data, f.size()); data += f.size();
+                }
             };
 
             Function<FuncType::Matsubara,   PartType::Boson,       Value> boson_;
@@ -180,6 +245,130 @@ namespace obs {
             std::vector<ut::complex> data_;   // always complex
         };
         
+        
+        
+        //Matsubara frequencies from the non-uniform FFT of the samples, same layout as FuncType::Matsubara
+        
+        template<typename Value>
+        struct Basis<Value, FuncType::Nfft, cfg::FermionicTime, cfg::FermionicTime> {
+            
+            void store(jsx::value& measurements, std::int64_t samples) {
+                fermion_.transform(data_.data());
+                
+                measurements << meas::fix(data_, samples);
+                
+                std::fill(data_.begin(), data_.end(), .0);
+            };
+            
+        protected:
+            Basis() = delete;
+            Basis(jsx::value const& jWorm, data::Data<Value> const& data) :
+            fermion_(nfft::Axis(PartType::Fermion, jWorm("cutoff").int64(), std::is_same<Value, ut::complex>::value)),
+            data_(fermion_.size(), .0) {
+            };
+            Basis(Basis const&) = delete;
+            Basis(Basis&&) = default;
+            Basis& operator=(Basis const&) = delete;
+            Basis& operator=(Basis&&) = delete;
+            ~Basis() = default;
+            
+            void add(Value const sign, cfg::FermionicTime const& op1, cfg::FermionicTime const& op2) {
+                fermion_.add(sign, op1.key() - op2.key());
+            };
+            
+            nfft::Line fermion_;
+            
+            std::vector<ut::complex> data_;
+        };
+        
+        
+        template<typename Value>
+        struct Basis<Value, FuncType::Nfft, cfg::FermionicTime, cfg::FermionicTime, cfg::FermionicTime, cfg::FermionicTime> {
+            
+            void store(jsx::value& measurements, std::int64_t samples) {
+            };
+            
+        protected:
+            Basis() = delete;
+            Basis(jsx::value const& jWorm, data::Data<Value> const& data) {
+                throw std::runtime_error("obs::worm::Basis: nfft basis not available for four-time worms, use matsubara");
+            };
+            Basis(Basis const&) = delete;
+            Basis(Basis&&) = default;
+            Basis& operator=(Basis const&) = delete;
+            Basis& operator=(Basis&&) = delete;
+            ~Basis() = default;
+            
+            void add(Value const sign, cfg::FermionicTime const& op1, cfg::FermionicTime const& op2, cfg::FermionicTime const& op3, cfg::FermionicTime const& op4) {
+            };
+        };
+        
+        
+        template<typename Value>
+        struct Basis<Value, FuncType::Nfft, cfg::BosonicTime, cfg::BosonicTime> {
+            
+            void store(jsx::value& measurements, std::int64_t samples) {
+                boson_.transform(data_.data());
+                
+                measurements << meas::fix(data_, samples);
+                
+                std::fill(data_.begin(), data_.end(), .0);
+            };
+            
+        protected:
+            Basis() = delete;
+            Basis(jsx::value const& jWorm, data::Data<Value> const& data) :
+            boson_(nfft::Axis(PartType::Boson, jWorm("cutoff").int64(), std::is_same<Value, ut::complex>::value)),
+            data_(boson_.size(), .0) {
+            };
+            Basis(Basis const&) = delete;
+            Basis(Basis&&) = default;
+            Basis& operator=(Basis const&) = delete;
+            Basis& operator=(Basis&&) = delete;
+            ~Basis() = default;
+            
+            void add(Value const sign, cfg::BosonicTime const& op1, cfg::BosonicTime const& op2) {
+                boson_.add(sign, op1.key() - op2.key());
+            };
+            
+            nfft::Line boson_;
+            
+            std::vector<ut::complex> data_;
+        };
+        
+        
+        template<typename Value>
+        struct Basis<Value, FuncType::Nfft, cfg::FermionicTime, cfg::FermionicTime, cfg::BosonicTime> {
+            
+            void store(jsx::value& measurements, std::int64_t samples) {
+                grid_.transform(data_.data());
+                
+                measurements << meas::fix(data_, samples);
+                
+                std::fill(data_.begin(), data_.end(), .0);
+            };
+            
+        protected:
+            Basis() = delete;
+            Basis(jsx::value const& jWorm, data::Data<Value> const& data) :
+            grid_(nfft::Axis(PartType::Fermion, jWorm("fermion cutoff").int64(), true), nfft::Axis(PartType::Boson, jWorm("boson cutoff").int64(), std::is_same<Value, ut::complex>::value)),
+            data_(grid_.size(), .0) {
+            };
+            Basis(Basis const&) = delete;
+            Basis(Basis&&) = default;
+            Basis& operator=(Basis const&) = delete;
+            Basis& operator=(Basis&&) = delete;
+            ~Basis() = default;
+            
+            void add(Value const sign, cfg::FermionicTime const& op1, cfg::FermionicTime const& op2, cfg::BosonicTime const& op3) {
+                grid_.add(sign, op1.key() - op2.key(), op2.key() - op3.key());
+            };
+            
+            nfft::Plane grid_;
+            
+            std::vector<ut::complex> data_;
+        };
+        
     }
     
 }
@@ -10,7 +10,7 @@ namespace obs {
     namespace worm {
 
         
-        enum class FuncType { Matsubara, Legendre };
+        enum class FuncType { Matsubara, Legendre, Nfft };
         
         enum class PartType { Fermion, Boson };
         
@@ -62,10 +62,13 @@ namespace obs {
         
         
         
+        //the product is written out, std::complex multiplication goes through the inf/nan recovery of __muldc3
         template<typename Iterator>
         void set_matsubara(Iterator start, Iterator end, ut::complex val, ut::complex const fact) {
+            double re = val.real(), im = val.imag();
             for(Iterator it = start; it != end; ++it) {
-                *it = val; val *= fact;
+                *it = ut::complex(re, im);
+                double const temp = re*fact.real() - im*fact.imag(); im = re*fact.imag() + im*fact.real(); re = temp;
             }
         }
         
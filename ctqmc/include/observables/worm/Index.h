@@ -62,6 +62,15 @@ namespace obs {
                 return get_integer(worm, ut::make_sequence_t<0, sizeof...(Ops)>());
             };
             
+            //same as string(worm) for the worm with integer(worm) == integer
+            std::string string(std::size_t integer) const {
+                std::string name = std::to_string(integer%N_);
+                for(std::size_t d = 1; d < get_dim<flavor_trait_t<Ops>...>::value; ++d) {
+                    integer /= N_; name += "_" + std::to_string(integer%N_);
+                }
+                return name;
+            };
+            
         private:
             std::size_t const N_, D_;
             
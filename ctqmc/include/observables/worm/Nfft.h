@@ -0,0 +1,231 @@
+#ifndef CTQMC_INCLUDE_OBSERVABLES_WORM_NFFT_H
+#define CTQMC_INCLUDE_OBSERVABLES_WORM_NFFT_H
+
+#include <cmath>
+#include <vector>
+#include <stdexcept>
+
+#include "Function.h"
+#include "../../Utilities.h"
+
+//Non-uniform FFT (type 1, gaussian gridding as in Greengard and Lee, SIAM Rev. 46, 443 (2004)) of the worm samples.
+//
+//With v = tau/beta mod 1 the Matsubara exponentials are exp(i w_n tau) = phase*exp(2 pi i n v), where the phase is exp(i pi tau/beta) for
+//fermions and 1 for bosons. The samples are spread onto an oversampled grid in v with a gaussian, and the frequencies n in [-cutoff, cutoff)
+//are obtained at store time by a FFT of the grid and division by the fourier transform of the gaussian.
+//
+//The grids are allocated with the first sample, since most entries of a tensor valued worm observable are never sampled and a Plane is
+//large (e.g. 256 x 64 complex numbers for fermion cutoff 50 and boson cutoff 10).
+
+namespace obs {
+
+    namespace worm {
+
+        namespace nfft {
+
+            int const spread = 12;           // half width of the spreading kernel, relative accuracy about 1e-12 with oversampling 2
+
+
+            //data[k] <- sum_j data[j] exp(2 pi i j k/size), size is a power of two
+            struct Fft {
+                Fft() = delete;
+                explicit Fft(std::size_t size) : size_(size), twiddle_(size/2) {
+                    if(size_ & (size_ - 1)) throw std::runtime_error("obs::worm::nfft::Fft: size is not a power of two");
+                    for(std::size_t k = 0; k < twiddle_.size(); ++k) twiddle_[k] = std::polar(1., 2.*M_PI*k/size_);
+                };
+                Fft(Fft const&) = default;
+                Fft(Fft&&) = default;
+                Fft& operator=(Fft const&) = delete;
+                Fft& operator=(Fft&&) = delete;
+                ~Fft() = default;
+
+                void operator()(ut::complex* data) const {
+                    for(std::size_t i = 1, j = 0; i < size_; ++i) {
+                        std::size_t bit = size_ >> 1;
+                        for(; j & bit; bit >>= 1) j ^= bit;
+                        j ^= bit; if(i < j) std::swap(data[i], data[j]);
+                    }
+
+                    for(std::size_t length = 2; length <= size_; length <<= 1) {
+                        std::size_t const half = length/2, step = size_/length;
+                        for(std::size_t start = 0; start < size_; start += length)
+                            for(std::size_t k = 0; k < half; ++k) {
+                                ut::complex const& w = twiddle_[k*step]; ut::complex& a = data[start + k]; ut::complex& b = data[start + k + half];
+                                ut::complex const temp(w.real()*b.real() - w.imag()*b.imag(), w.real()*b.imag() + w.imag()*b.real());
+                                b = a - temp; a += temp;
+                            }
+                    }
+                };
+
+            private:
+                std::size_t const size_;
+                std::vector<ut::complex> twiddle_;
+            };
+
+
+            //One dimension of the grid: frequencies as in Function<FuncType::Matsubara, partType, Value>
+            struct Axis {
+                Axis() = delete;
+                Axis(PartType partType, int cutoff, bool negative) :
+                fermion_(partType == PartType::Fermion),
+                size_(grid_size(cutoff)),
+                tau_(M_PI*spread/(4.*cutoff*cutoff*(size_/(2.*cutoff))*(size_/(2.*cutoff) - .5))),
+                fft_(size_),
+                e3_(2*spread) {
+                    if(negative)
+                        for(int n = fermion_ ? -cutoff : -cutoff + 1; n < cutoff; ++n) frequencies_.push_back(n);
+                    else
+                        for(int n = 0; n < cutoff; ++n) frequencies_.push_back(n);
+
+                    double const h = 2.*M_PI/size_;
+                    for(int l = 0; l < 2*spread; ++l) e3_[l] = std::exp(-(l - spread + 1)*h*(l - spread + 1)*h/(4.*tau_));
+                };
+                Axis(Axis const&) = default;
+                Axis(Axis&&) = default;
+                Axis& operator=(Axis const&) = delete;
+                Axis& operator=(Axis&&) = delete;
+                ~Axis() = default;
+
+                std::size_t size() const { return size_;};
+                std::vector<int> const& frequencies() const { return frequencies_;};
+
+                //the sample at key goes with phase*weights[l] to the grid points (start + l) mod size
+                ut::complex weights(ut::KeyType key, double* weights, std::size_t& start) const {
+                    ut::complex const phase = fermion_ ? ut::complex(std::cos(M_PI*key/ut::KeyMax), std::sin(M_PI*key/ut::KeyMax)) : 1.;
+
+                    double const x = 2.*M_PI*(key < 0 ? key + ut::KeyMax : key)/ut::KeyMax, h = 2.*M_PI/size_;
+                    std::size_t const m0 = std::min(static_cast<std::size_t>(x/h), size_ - 1); double const d = x - m0*h;
+
+                    double const e1 = std::exp(-d*d/(4.*tau_)), e2 = std::exp(d*h/(2.*tau_));
+                    double power = e1*std::pow(e2, -spread + 1);
+                    for(int l = 0; l < 2*spread; ++l) {
+                        weights[l] = power*e3_[l]; power *= e2;
+                    }
+
+                    start = (m0 + size_ - spread + 1) & (size_ - 1);
+                    return phase;
+                };
+
+                void transform(ut::complex* grid) const {
+                    fft_(grid);
+                };
+
+                //value of frequency n = grid[n mod size]*factor(n) after the transform
+                double factor(int n) const {
+                    return std::exp(n*n*tau_)/(size_*std::sqrt(tau_/M_PI));
+                };
+
+            private:
+                bool const fermion_;
+                std::size_t const size_;
+                double const tau_;
+                Fft const fft_;
+                std::vector<double> e3_;
+                std::vector<int> frequencies_;
+
+                static std::size_t grid_size(int cutoff) {
+                    if(cutoff < 1) throw std::runtime_error("obs::worm::nfft::Axis: invalid cutoff");
+                    std::size_t size = 32; while(size < 4*static_cast<std::size_t>(cutoff)) size <<= 1;
+                    return size;
+                };
+            };
+
+
+            struct Line {
+                Line() = delete;
+                explicit Line(Axis axis) : axis_(std::move(axis)) {};
+                Line(Line const&) = delete;
+                Line(Line&&) = default;
+                Line& operator=(Line const&) = delete;
+                Line& operator=(Line&&) = delete;
+                ~Line() = default;
+
+                std::size_t size() const { return axis_.frequencies().size();};
+
+                void add(ut::complex value, ut::KeyType key) {
+                    double weights[2*spread]; std::size_t start;
+                    value *= axis_.weights(key, weights, start);
+
+                    if(grid_.empty()) grid_.assign(axis_.size(), .0);
+                    std::size_t const mask = axis_.size() - 1;
+                    for(int l = 0; l < 2*spread; ++l)
+                        grid_[(start + l) & mask] += weights[l]*value;
+                };
+
+                //data += transformed grid, the grid is reset
+                void transform(ut::complex* data) {
+                    if(grid_.empty()) return;
+                    
+                    axis_.transform(grid_.data()); std::size_t const mask = axis_.size() - 1;
+
+                    for(auto n : axis_.frequencies()) *data++ += axis_.factor(n)*grid_[n & mask];
+
+                    std::fill(grid_.begin(), grid_.end(), .0);
+                };
+
+            private:
+                Axis axis_;
+                std::vector<ut::complex> grid_;  // empty until the first sample
+            };
+
+
+            //grid index k1 + size1*k2, the transformed data is ordered with the first axis fastest
+            struct Plane {
+                Plane() = delete;
+                Plane(Axis axis1, Axis axis2) : axis1_(std::move(axis1)), axis2_(std::move(axis2)) {};
+                Plane(Plane const&) = delete;
+                Plane(Plane&&) = default;
+                Plane& operator=(Plane const&) = delete;
+                Plane& operator=(Plane&&) = delete;
+                ~Plane() = default;
+
+                std::size_t size() const { return axis1_.frequencies().size()*axis2_.frequencies().size();};
+
+                void add(ut::complex value, ut::KeyType key1, ut::KeyType key2) {
+                    double weights1[2*spread], weights2[2*spread]; std::size_t start1, start2;
+                    value *= axis1_.weights(key1, weights1, start1)*axis2_.weights(key2, weights2, start2);
+
+                    if(grid_.empty()) { grid_.assign(axis1_.size()*axis2_.size(), .0); column_.resize(axis2_.size());}
+                    std::size_t const size1 = axis1_.size(), mask1 = axis1_.size() - 1, mask2 = axis2_.size() - 1;
+                    for(int l2 = 0; l2 < 2*spread; ++l2) {
+                        ut::complex* row = grid_.data() + size1*((start2 + l2) & mask2); ut::complex const temp = weights2[l2]*value;
+                        for(int l1 = 0; l1 < 2*spread; ++l1)
+                            row[(start1 + l1) & mask1] += weights1[l1]*temp;
+                    }
+                };
+
+                //data += transformed grid, the grid is reset. Only the columns of the measured frequencies are transformed along the second axis.
+                void transform(ut::complex* data) {
+                    if(grid_.empty()) return;
+                    
+                    std::size_t const size1 = axis1_.size(), mask1 = axis1_.size() - 1, mask2 = axis2_.size() - 1;
+
+                    for(std::size_t k2 = 0; k2 < axis2_.size(); ++k2) axis1_.transform(grid_.data() + size1*k2);
+
+                    std::size_t const stride = axis1_.frequencies().size(); std::size_t i1 = 0;
+                    for(auto n1 : axis1_.frequencies()) {
+                        for(std::size_t k2 = 0; k2 < axis2_.size(); ++k2) column_[k2] = grid_[(n1 & mask1) + size1*k2];
+                        axis2_.transform(column_.data());
+
+                        std::size_t i2 = 0;
+                        for(auto n2 : axis2_.frequencies())
+                            data[i1 + stride*i2++] += axis1_.factor(n1)*axis2_.factor(n2)*column_[n2 & mask2];
+                        ++i1;
+                    }
+
+                    std::fill(grid_.begin(), grid_.end(), .0);
+                };
+
+            private:
+                Axis axis1_, axis2_;
+                std::vector<ut::complex> grid_;  // empty until the first sample
+                std::vector<ut::complex> column_;
+            };
+
+        }
+
+    }
+
+}
+
+#endif
@@ -22,7 +22,7 @@ namespace obs {
             samples_(0),
             samples0_(0),
             index_(data.ops().flavors()),
-            ptrs_(index_.size(), nullptr) {
+            meas_(index_.size()) {
             };
             Observable(Observable const&) = delete;
             Observable(Observable&&) = delete;
@@ -31,15 +31,13 @@ namespace obs {
             ~Observable() = default;
             
             bool sample(Value const sign, data::Data<Value> const& data, state::State<Value>& state, jsx::value& measurements, imp::itf::Batcher<Value>& batcher) {
-                auto const integer_index = index_.integer(cfg::get<Worm>(state.worm()));
+                auto const index = index_.integer(cfg::get<Worm>(state.worm()));
                 
-                if(ptrs_[integer_index] == nullptr) {
-                    auto const string_index = Index<Worm>::string(cfg::get<Worm>(state.worm()));
-                    meas_.emplace(string_index, Meas<Mode, Value, funcType, measType, Worm>(jWorm_, data));
-                    ptrs_[integer_index] = &meas_.at(string_index);
+                if(meas_[index].get() == nullptr) {
+                    meas_[index].reset(new Meas<Mode, Value, funcType, measType, Worm>(jWorm_, data)); entries_.push_back(index);
                 }
                 
-                ptrs_[integer_index]->add(sign, data, state);
+                meas_[index]->add(sign, data, state);
                 
                 ++samples_; if(samples_%store_ == 0) store(data, measurements);
                 
@@ -47,35 +45,31 @@ namespace obs {
             };
             
             void finalize(data::Data<Value> const& data, jsx::value& measurements) {
-                std::size_t size = meas_.size(); std::size_t length = 0;
-                for(auto const& basis : meas_) length = std::max(length, basis.first.size() + 1);
-                mpi::all_reduce<mpi::op::max>(size); mpi::all_reduce<mpi::op::max>(length);
+                std::vector<std::uint64_t> occupied((meas_.size() + 63)/64, 0);
+                for(auto i : entries_) occupied[i/64] |= std::uint64_t(1) << i%64;
                 
-                std::vector<char> entries(size*length, '\0'); std::size_t pos = 0;
-                for(auto const& basis : meas_) std::copy(basis.first.begin(), basis.first.end(), &entries[length*pos++]);
-                mpi::gather(entries, mpi::master);
+                mpi::all_reduce<mpi::op::bor>(occupied);
                 
-                std::vector<char> allEntries; std::int64_t allSize;
-                if(mpi::rank() == mpi::master) {
-                    std::set<std::string> guard;
-                    for(pos = 0; pos*length < entries.size(); ++pos)
-                        if(entries[pos*length] != '\0') guard.insert(std::string(&entries[pos*length]));
-                    allEntries.resize(guard.size()*length, '\0'); pos = 0;
-                    for(auto const& entry : guard) std::copy(entry.begin(), entry.end(), &allEntries[length*pos++]);
-                    allSize = allEntries.size(); mpi::bcast(allSize, mpi::master);
-                } else {
-                    mpi::bcast(allSize, mpi::master); allEntries.resize(allSize);
-                }
-                mpi::bcast(allEntries, mpi::master);
-
-                for(pos = 0; pos*length < allEntries.size(); ++pos) {
-                    std::string const entry(&allEntries[pos*length]);
-                    if(!meas_.count(entry)) meas_.emplace(entry, Meas<Mode, Value, funcType, measType, Worm>(jWorm_, data));
-                }
+                for(std::size_t i = 0; i < meas_.size(); ++i)
+                    if(occupied[i/64] & (std::uint64_t(1) << i%64) && meas_[i].get() == nullptr) {
+                        meas_[i].reset(new Meas<Mode, Value, funcType, measType, Worm>(jWorm_, data)); entries_.push_back(i);
+                    }
                 
                 store(data, measurements);
             };
             
+            void flush(data::Data<Value> const& data, jsx::value& measurements) {
+                store(data, measurements);
+            };
+            
+            jsx::value json() const {
+                return jsx::object_t{{ "samples", static_cast<std::int64_t>(samples0_) }};
+            };
+            
+            void restore(jsx::value const& jObservable) {
+                samples0_ = jObservable("samples").int64();
+            };
+            
         private:
             std::int64_t const store_;
             jsx::value const jWorm_;
@@ -83,19 +77,19 @@ namespace obs {
             std::size_t samples_, samples0_;
             
             Index<Worm> index_;
-            std::vector<Meas<Mode, Value, funcType, measType, Worm>*> ptrs_;
-            std::map<std::string, Meas<Mode, Value, funcType, measType, Worm>> meas_;
+            std::vector<std::unique_ptr<Meas<Mode, Value, funcType, measType, Worm>>> meas_;  // by Index<Worm>::integer, names only when stored
+            std::vector<std::size_t> entries_;
             
             
             void store(data::Data<Value> const& data, jsx::value& measurements) {
                 samples0_ += samples_;
                 
-                for(auto& basis : meas_) {
-                    auto& entry = measurements[measType == MeasType::Static ? "static" : "dynamic"][basis.first];
+                for(auto i : entries_) {
+                    auto& entry = measurements[measType == MeasType::Static ? "static" : "dynamic"][index_.string(i)];
                     if(entry.template is<jsx::empty_t>())
-                        basis.second.store(entry, samples0_);
+                        meas_[i]->store(entry, samples0_);
                     else
-                        basis.second.store(entry, samples_);
+                        meas_[i]->store(entry, samples_);
                 }
                 
                 samples_ = 0;
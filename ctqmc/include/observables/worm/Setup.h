@@ -18,6 +18,8 @@ namespace obs {
             observables.template add<worm::Observable<Mode, Value, worm::FuncType::Matsubara, measType, Worm>>(sweep, store, jWorm, data);
         else if(jWorm("basis").string() == "legendre")
             observables.template add<worm::Observable<Mode, Value, worm::FuncType::Legendre, measType, Worm>>(sweep, store, jWorm, data);
+        else if(jWorm("basis").string() == "nfft")
+            observables.template add<worm::Observable<Mode, Value, worm::FuncType::Nfft, measType, Worm>>(sweep, store, jWorm, data);
         else
             throw std::runtime_error("Unknown basis option");
     }
@@ -28,7 +30,7 @@ namespace obs {
     {
         auto const& jWorm = jParams(Worm::name());
         
-        observables.reset(new WormObservables<Value>(Worm::name()));
+        observables.reset(new WormObservables<Value>(Worm::name(), jParams));
         
         if(jWorm.is("static"))
             add_obs<Mode, Worm, worm::MeasType::Static>(jWorm, data, *observables);
@@ -35,7 +35,7 @@ namespace upd {
         bool surviving(Update const& update, data::Data<Value> const& data, state::State<Value>& state) {
             if(!update.template impurity<Mode>(data, state)) return false;
             
-            densityMatrix_ = imp::DensityMatrix<Mode, Value>(state.product(), data.eig());
+            densityMatrix_ = imp::DensityMatrix<Mode, Value>(state.product(), data.eig(), state.pruning().sectors());
             return ut::Flag::Pending == densityMatrix_.surviving(data.eig());
         };
         
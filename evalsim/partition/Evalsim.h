@@ -36,7 +36,7 @@ namespace evalsim {
             
             jParams["hloc"] = ga::read_hloc<Value>("hloc.json");
             
-            jParams["operators"] = ga::construct_annihilation_operators<Value>(jParams("hloc"));
+            jParams["operators"] = ga::construct_annihilation_operators<Value>(jParams("hloc"), jParams.is("threads") ? jParams("threads").int64() : 1);
             
             if(jParams.is("dyn"))
                 jParams("dyn")("functions") = mpi::read(jParams("dyn")("functions").string());
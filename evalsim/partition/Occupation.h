@@ -2,6 +2,10 @@
 #define EVALSIM_PARTITION_OCCUPATION_H
 
 
+#include <thread>
+#include <numeric>
+#include <exception>
+
 #include "ReadDensityMatrix.h"
 
 #include "../../include/linalg/Operators.h"
@@ -14,6 +18,78 @@ namespace evalsim {
     namespace partition {
         
         
+        namespace occupation {
+            
+            //tr(rho A_i B_j) = sum_s sum_k L_i^s[k] R_j^s[k] for block-diagonal rho and products A_i B_j mapping each sector s back to s,
+            //with the left and right factors L_i^s and R_j^s computed once per operator. The product operators are never formed.
+            template<typename Value>
+            struct Contraction {
+                Contraction() = delete;
+                Contraction(std::size_t N, std::size_t sectors) : left_(N, std::vector<io::Matrix<Value>>(sectors)), right_(left_), target_(N, std::vector<int>(sectors, -1)), source_(target_) {};
+                Contraction(Contraction const&) = delete;
+                Contraction(Contraction&&) = delete;
+                Contraction& operator=(Contraction const&) = delete;
+                Contraction& operator=(Contraction&&) = delete;
+                ~Contraction() = default;
+                
+                io::Matrix<Value>& left(std::size_t i, std::size_t s) { return left_[i][s];};
+                io::Matrix<Value>& right(std::size_t i, std::size_t s) { return right_[i][s];};
+                
+                //B_j maps s to t, and A_i maps t back to s
+                void set(std::size_t i, int s, int t) {
+                    if(source_[i][t] != -1) throw std::runtime_error("evalsim::partition::occupation: operator has invalid block structure");
+                    target_[i][s] = t; source_[i][t] = s;
+                };
+                
+                Value operator()(std::size_t i, std::size_t j) const {
+                    Value result = .0;
+                    
+                    for(std::size_t s = 0; s < target_[j].size(); ++s)
+                        if(target_[j][s] != -1 && source_[i][target_[j][s]] != -1) {
+                            if(source_[i][target_[j][s]] != static_cast<int>(s))
+                                throw std::runtime_error("evalsim::partition::occupation: product is not block-diagonal");
+                            
+                            auto const& left = left_[i][s]; auto const& right = right_[j][s];
+                            
+                            Value temp = .0;
+                            for(std::size_t k = 0; k < static_cast<std::size_t>(left.I())*left.J(); ++k)
+                                temp += left.data()[k]*right.data()[k];
+                            result += temp;
+                        }
+                    
+                    return result;
+                };
+                
+            private:
+                std::vector<std::vector<io::Matrix<Value>>> left_, right_;
+                std::vector<std::vector<int>> target_, source_;
+            };
+            
+            
+            //evaluates f(index) for the indices on a number of threads
+            template<typename F>
+            void for_each(std::vector<std::size_t> const& indices, std::size_t numberOfThreads, F f) {
+                std::vector<std::exception_ptr> errors(std::max<std::size_t>(numberOfThreads, 1));
+                std::vector<std::thread> workers;
+                
+                for(std::size_t t = 0; t < errors.size(); ++t)
+                    workers.emplace_back([&, t]() {
+                        try {
+                            for(std::size_t n = t; n < indices.size(); n += errors.size()) f(indices[n]);
+                        } catch(...) {
+                            errors[t] = std::current_exception();
+                        }
+                    });
+                
+                for(auto& worker : workers) worker.join();
+                
+                for(auto& error : errors)
+                    if(error) std::rethrow_exception(error);
+            };
+            
+        }
+        
+        
         template<typename Value>
         jsx::value get_occupation(jsx::value const& jParams, jsx::value const& jMeasurements, io::Matrix<Value>& occupation, io::Matrix<Value>& correlation)
         {
@@ -23,15 +99,41 @@ namespace evalsim {
             mpi::cout << "Calculating occupation ... " << std::flush;
             
             jsx::value const& jHybMatrix = jParams("hybridisation")("matrix");
+            jsx::value const& jOperators = jParams("operators");
             jsx::value jDensityMatrix = meas::read_density_matrix<Value>(jParams, jMeasurements("density matrix"));
-        
-            
-            jsx::value jn = jsx::array_t(jHybMatrix.size());
-            
-            for(std::size_t i = 0; i < jHybMatrix.size(); ++i)
-                linalg::mult<Value>('c', 'n', 1., jParams("operators")(i), jParams("operators")(i), .0, jn(i));
             
             std::size_t const N = jHybMatrix.size();
+            std::size_t const sectors = jDensityMatrix.size();
+            std::size_t const numberOfThreads = jParams.is("threads") ? jParams("threads").int64() : 1;
+            
+            
+            // <c_i^+ c_j> = sum_s tr( conj(c_i^s) .* (c_j^s rho^s) ), defined if c_i and c_j map s to the same sector
+            // <n_i n_j> = sum_s tr( (rho^s n_i^s)^T .* n_j^s ) with n_i^s = c_i^s^+ c_i^s
+            occupation::Contraction<Value> occ(N, sectors), corr(N, sectors);
+            
+            std::vector<std::size_t> operators(N); std::iota(operators.begin(), operators.end(), 0);
+            occupation::for_each(operators, numberOfThreads, [&](std::size_t i) {
+                for(std::size_t s = 0; s < sectors; ++s)
+                    if(!jOperators(i)(s)("target").is<jsx::null_t>()) {
+                        int const t = jOperators(i)(s)("target").int64();
+                        auto const& op = jsx::at<io::Matrix<Value>>(jOperators(i)(s)("matrix"));
+                        auto const& rho = jsx::at<io::Matrix<Value>>(jDensityMatrix(s)("matrix"));
+                        
+                        occ.set(i, s, t);
+                        occ.left(i, s).resize(op.I(), op.J());
+                        for(std::size_t k = 0; k < static_cast<std::size_t>(op.I())*op.J(); ++k)
+                            occ.left(i, s).data()[k] = ut::conj(op.data()[k]);
+                        occ.right(i, s).resize(op.I(), op.J());
+                        linalg::mult<Value>('n', 'n', 1., op, rho, .0, occ.right(i, s));
+                        
+                        corr.set(i, s, s);
+                        corr.right(i, s).resize(op.J(), op.J());
+                        linalg::mult<Value>('c', 'n', 1., op, op, .0, corr.right(i, s));
+                        corr.left(i, s).resize(op.J(), op.J());
+                        linalg::mult<Value>('t', 't', 1., corr.right(i, s), rho, .0, corr.left(i, s));
+                    }
+            });
+            
             std::size_t const size = N*N;
             std::size_t rank = 0;
             std::size_t chunk = 0;
@@ -46,24 +148,18 @@ namespace evalsim {
             std::vector<Value> occupation_tmp(size,0);
             std::vector<Value> correlation_tmp(size,0);
             
-            for(std::size_t index = rank*chunk; index < chunk*(rank + 1); ++index){
-                if (index>=size) break;
-                
+            std::vector<std::size_t> indices;
+            for(std::size_t index = rank*chunk; index < std::min(chunk*(rank + 1), size); ++index) indices.push_back(index);
+            
+            occupation::for_each(indices, numberOfThreads, [&](std::size_t index) {
                 std::size_t const i = index%(N);
                 std::size_t const j = index/(N);
                 
-                std::string entry = jHybMatrix(i)(j).string();
-                    
-                if(!entry.empty()) {
-                    jsx::value jOccupation;
-                    linalg::mult<Value>('c', 'n', 1., jParams("operators")(i), jParams("operators")(j), .0, jOccupation);
-                    occupation_tmp[i*N+j] = linalg::trace<Value>(jDensityMatrix, jOccupation);
-                }
-                    
-                jsx::value jCorrelation;
-                linalg::mult<Value>('n', 'n', 1., jn(i), jn(j), .0, jCorrelation);
-                correlation_tmp[i*N+j] = linalg::trace<Value>(jDensityMatrix, jCorrelation);
-            }
+                if(!jHybMatrix(i)(j).string().empty())
+                    occupation_tmp[i*N+j] = occ(i, j);
+                
+                correlation_tmp[i*N+j] = corr(i, j);
+            });
             
             if (chunk != size){
                 mpi::reduce<mpi::op::sum>(occupation_tmp, mpi::master);
@@ -204,13 +204,13 @@ namespace evalsim {
             //double const beta = jParams("beta").real64();
             int const pos_and_neg_freq = (std::is_same<Value,double>::value ? 1 : 2);
             int const nMatGB = pos_and_neg_freq*jWorm("boson cutoff").int64()-pos_and_neg_freq+1;
-            int const nMatGF = 2*(jWorm("basis").string() == "matsubara" ? jWorm("fermion cutoff").int64() : ( jWorm.is("fermion cutoff") ? jWorm("fermion cutoff").int64() : 50 ));
+            int const nMatGF = 2*((jWorm("basis").string() == "matsubara" || jWorm("basis").string() == "nfft") ? jWorm("fermion cutoff").int64() : ( jWorm.is("fermion cutoff") ? jWorm("fermion cutoff").int64() : 50 ));
             
             func::OmegaMap omega_f(nMatGF,false,true);
             func::OmegaMap omega_b(nMatGB,true,!std::is_same<Value,double>::value);
             
             int const nMatGB_kernel = 2*jWorm("boson cutoff").int64()-1;
-            int const nMatGF_kernel = 2*(jWorm("basis").string() == "matsubara" ? jWorm("fermion cutoff").int64() : ( jWorm.is("fermion cutoff") ? jWorm("fermion cutoff").int64() : 50 ));
+            int const nMatGF_kernel = 2*((jWorm("basis").string() == "matsubara" || jWorm("basis").string() == "nfft") ? jWorm("fermion cutoff").int64() : ( jWorm.is("fermion cutoff") ? jWorm("fermion cutoff").int64() : 50 ));
             
             func::OmegaMap omega_f_kernel(nMatGF_kernel,false,true);
             func::OmegaMap omega_b_kernel(nMatGB_kernel,true,true);
@@ -405,7 +405,7 @@ namespace evalsim {
             
             //Kernels are always for full +/- frequency range
             auto const name_kernel = cfg::hedin_ph_imprsum::Worm::name();
-            int const nMatGF_kernel = 2*(jParams(name_kernel)("basis").string() == "matsubara" ? jParams(name_kernel)("fermion cutoff").int64() : ( jParams(name_kernel).is("fermion cutoff") ? jParams(name_kernel)("fermion cutoff").int64() : 50 ));
+            int const nMatGF_kernel = 2*((jParams(name_kernel)("basis").string() == "matsubara" || jParams(name_kernel)("basis").string() == "nfft") ? jParams(name_kernel)("fermion cutoff").int64() : ( jParams(name_kernel).is("fermion cutoff") ? jParams(name_kernel)("fermion cutoff").int64() : 50 ));
             int const nMatGB_kernel = 2*jParams(name_kernel)("boson cutoff").int64()-1;
             
             func::OmegaMap omega_f_kernel(nMatGF_kernel,false,true);
@@ -23,7 +23,7 @@ namespace evalsim {
             
             jParams["hloc"] = ga::read_hloc<Value>("hloc.json");
             
-            jParams["operators"] = ga::construct_annihilation_operators<Value>(jParams("hloc"));
+            jParams["operators"] = ga::construct_annihilation_operators<Value>(jParams("hloc"), jParams.is("threads") ? jParams("threads").int64() : 1);
             
             double const beta = jParams("beta").real64();
             func::iOmega const iomega(beta); auto const oneBody = jsx::at<io::Matrix<Value>>(jParams("hloc")("one body"));
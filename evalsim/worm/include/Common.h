@@ -41,7 +41,7 @@ namespace evalsim {
                 Frequencies(jsx::value const& jWorm) :
                 pos_and_neg_freq_(std::is_same<Value,double>::value ? 1 : 2),
                 nMatGB_(pos_and_neg_freq_*jWorm("boson cutoff").int64()-pos_and_neg_freq_+1),
-                nMatGF_(2*(jWorm("basis").string() == "matsubara" ? jWorm("fermion cutoff").int64() : ( jWorm.is("matsubara cutoff") ? jWorm("matsubara cutoff").int64() : 50 ))),
+                nMatGF_(2*((jWorm("basis").string() == "matsubara" || jWorm("basis").string() == "nfft") ? jWorm("fermion cutoff").int64() : ( jWorm.is("matsubara cutoff") ? jWorm("matsubara cutoff").int64() : 50 ))),
                 omega_b_(nMatGB_,true,!std::is_same<Value,double>::value),
                 omega_f_(nMatGF_,false,true){}
                 
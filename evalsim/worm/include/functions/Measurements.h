@@ -220,7 +220,7 @@ namespace evalsim {
                 
                 template<typename Value, typename ... Args>
                 inline io::cvec read_function(jsx::value const& jFunction, jsx::value const& jParams, jsx::value const& jPartition, int hybSize, bool scale, bool force_matsubara = false) {
-                    if(force_matsubara or (jPartition.is("basis") ? jPartition("basis").string() == "matsubara" : true)) {
+                    if(force_matsubara or (jPartition.is("basis") ? (jPartition("basis").string() == "matsubara" || jPartition("basis").string() == "nfft") : true)) {
                         return read_matsubara_function(jParams,jPartition, jFunction, scale);
                     }else if(jPartition.is("basis") ? jPartition("basis").string() == "legendre" : true) {
                          Read_legendre_function<double,Args ...> rlf(jParams,jPartition);
@@ -151,6 +151,21 @@ inline void gesvd(char const* jobu, char const* jobvt, int const* m, int const*
 }
 
 
+//--------------------------------------------------------------------- single --------------------------------------------------------------------
+
+extern "C" {
+    void sgemm_(char const*, char const*, int const*, int const*, int const*, float const*, float const*, int const*, float const*, int const*, float const*, float*, int const*);
+    void cgemm_(char const*, char const*, int const*, int const*, int const*, std::complex<float> const*, std::complex<float> const*, int const*, std::complex<float> const*, int const*, std::complex<float> const*, std::complex<float>*, int const*);
+}
+
+
+inline void gemm(char const* transa, char const* transb, int const* m, int const* n, int const* k, float const* alpha, float const* a, int const* lda, float const* b, int const* ldb, float const* beta, float* c, int const* ldc) {
+    sgemm_(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+inline void gemm(char const* transa, char const* transb, int const* m, int const* n, int const* k, std::complex<float> const* alpha, std::complex<float> const* a, int const* lda, std::complex<float> const* b, int const* ldb, std::complex<float> const* beta, std::complex<float>* c, int const* ldc) {
+    cgemm_(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
 
 
 
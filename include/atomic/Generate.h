@@ -13,11 +13,20 @@
 #include <algorithm>
 #include <fstream>
 #include <string>
+#include <atomic>
+#include <thread>
+#include <tuple>
+#include <sstream>
+#include <limits>
+#include <cstdio>
+#include <exception>
 
 #include "Tensor.h"
 #include "../JsonX.h"
 #include "../io/Vector.h"
 #include "../io/Matrix.h"
+#include "../io/Mapped.h"
+#include "../io/Binary.h"
 #include "../linalg/LinAlg.h"
 #include "../mpi/Utilities.h"
 
@@ -98,62 +107,176 @@ namespace ga {
     //-----------------------------------------------------------------------------------------------------
     //-----------------------------------------------------------------------------------------------------
     
+    //Join on raw states for all threads at once: links are set with compare and swap, always from the larger to the smaller
+    //representative, such that the representatives are the smallest states of the subspaces, as with Join.
+    struct AtomicJoin {
+        AtomicJoin(std::size_t size) : labels_(size) {
+            for(std::size_t state = 0; state < size; ++state) labels_[state].store(state, std::memory_order_relaxed);
+        };
+        AtomicJoin(AtomicJoin const&) = delete;
+        AtomicJoin(AtomicJoin&&) = delete;
+        AtomicJoin& operator=(AtomicJoin const&) = delete;
+        AtomicJoin& operator=(AtomicJoin&&) = delete;
+        ~AtomicJoin() = default;
+        
+        void join(State state1, State state2) {
+            while(true) {
+                state1 = find_representative(state1);
+                state2 = find_representative(state2);
+                if(state1 == state2) return;
+                if(state1 < state2) std::swap(state1, state2);
+                if(labels_[state1].compare_exchange_strong(state1, state2)) return;
+            }
+        };
+        std::size_t clean() {   // not thread safe, relies on the parents being smaller
+            for(State state = 0; state < labels_.size(); ++state)
+                labels_[state].store(labels_[labels_[state].load()].load());
+            
+            std::size_t size = 0;
+            for(State state = 0; state < labels_.size(); ++state)
+                labels_[state].store(labels_[state].load() == state ? size++ : labels_[labels_[state].load()].load());
+            
+            return size;
+        };
+        State label(State state) const {
+            return labels_[state].load();
+        };
+    private:
+        std::vector<std::atomic<State>> labels_;
+        
+        State find_representative(State state) {
+            while(true) {
+                State parent = labels_[state].load();
+                if(parent == state) return state;
+                State const grand_parent = labels_[parent].load();
+                if(parent != grand_parent) labels_[state].compare_exchange_weak(parent, grand_parent);   // path halving
+                state = grand_parent;
+            }
+        };
+    };
+    
+    
+    //A product of creation and annihilation operators maps a state to a non-zero multiple of (state & ~touched) | value if
+    //the bits in one are set and those in zero are not, the sign does not matter for finding the blocks
+    struct Term {
+        State one, zero, touched, value;
+        
+        bool operator<(Term const& other) const {
+            return std::tie(one, zero, touched, value) < std::tie(other.one, other.zero, other.touched, other.value);
+        };
+    };
+    
+    //ops in order of application, flavor and dagger, false if the product vanishes
+    inline bool get_term(std::vector<std::pair<int, bool>> const& ops, Term& term) {
+        term = Term{0, 0, 0, 0};
+        
+        for(auto const& op : ops) {
+            State const bit = State(1) << op.first;
+            
+            if(!(term.touched & bit)) {
+                (op.second ? term.zero : term.one) |= bit;
+                term.touched |= bit; if(!op.second) term.value |= bit;
+            }
+            
+            if(static_cast<bool>(term.value & bit) == op.second) return false;
+            op.second ? term.value |= bit : term.value &= ~bit;
+        }
+        
+        return true;
+    };
+    
+    
     template<typename Value>
-    void find_blocks(Tensor<Value> const& hloc, BlockStates& blockStates)
+    std::vector<Term> get_terms(Tensor<Value> const& hloc)
     {
-        Join pre_block_labels(1 << hloc.N());
-      
-        for(State state = 0; state < (1 << hloc.N()); ++state) {
-            FlavorState const stateJ(state);
+        std::set<Term> terms; Term term;
+        
+        for(int fDagg = 0; fDagg < hloc.N(); ++fDagg)
+            for(int f = 0; f < hloc.N(); ++f)
+                if(std::abs(hloc.t(fDagg, f)) > 1.e-14 && get_term({{f, false}, {fDagg, true}}, term))
+                    terms.insert(term);
+        
+        for(int f1Dagg = 0; f1Dagg < hloc.N(); ++f1Dagg)
+            for(int f2Dagg = 0; f2Dagg < hloc.N(); ++f2Dagg)
+                for(int f1 = 0; f1 < hloc.N(); ++f1)
+                    for(int f2 = 0; f2 < hloc.N(); ++f2)
+                        if(std::abs(hloc.V(f1Dagg, f2Dagg, f1, f2)) > 1.e-14 && get_term({{f2, false}, {f1, false}, {f2Dagg, true}, {f1Dagg, true}}, term))
+                            terms.insert(term);
+        
+        std::vector<Term> result;
+        for(auto const& term : terms)
+            if(term.value != term.one) result.push_back(term);   // diagonal terms do not join anything
+        
+        return result;
+    };
+    
+    //-----------------------------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------------------------
+    
+    template<typename Value>
+    void find_blocks(Tensor<Value> const& hloc, BlockStates& blockStates, std::size_t numberOfThreads = 1)
+    {
+        if(hloc.N() >= 8*static_cast<int>(sizeof(State)) - 1)
+            throw std::runtime_error("ga::find_blocks: too many flavors");
+        
+        State const size = State(1) << hloc.N();
+        std::vector<Term> const terms = get_terms(hloc);
+        
+        AtomicJoin pre_block_labels(size);
+        
+        {
+            std::vector<std::thread> workers;
+            State const chunk = (size + std::max<std::size_t>(numberOfThreads, 1) - 1)/std::max<std::size_t>(numberOfThreads, 1);
             
-            for(int fDagg = 0; fDagg < hloc.N(); ++fDagg)
-                for(int f = 0; f < hloc.N(); ++f)
-                    if(std::abs(hloc.t(fDagg, f)) > 1.e-14) {
-                        FlavorState const stateI = psiDagg(fDagg, psi(f, stateJ));
-                        
-                        if(stateI.sign() != 0)
-                            pre_block_labels.join(stateI.state(), stateJ.state());
-                    }
+            for(State begin = 0; begin < size; begin += chunk)
+                workers.emplace_back([&, begin]() {
+                    for(State state = begin; state < std::min(begin + chunk, size); ++state)
+                        for(auto const& term : terms)
+                            if((state & term.one) == term.one && !(state & term.zero))
+                                pre_block_labels.join((state & ~term.touched) | term.value, state);
+                });
             
-            for(int f1Dagg = 0; f1Dagg < hloc.N(); ++f1Dagg)
-                for(int f2Dagg = 0; f2Dagg < hloc.N(); ++f2Dagg)
-                    for(int f1 = 0; f1 < hloc.N(); ++f1)
-                        for(int f2 = 0; f2 < hloc.N(); ++f2)
-                            if(std::abs(hloc.V(f1Dagg, f2Dagg, f1, f2)) > 1.e-14) {
-                                FlavorState const stateI = psiDagg(f1Dagg, psiDagg(f2Dagg, psi(f1, psi(f2, stateJ))));
-                                
-                                if(stateI.sign() != 0)
-                                    pre_block_labels.join(stateI.state(), stateJ.state());
-                            }
+            for(auto& worker : workers) worker.join();
         }
-
-        Join block_labels(pre_block_labels.clean());
+        
+        std::size_t const preBlockNumber = pre_block_labels.clean();
+        Join block_labels(preBlockNumber);
         
         for(int f = 0; f < hloc.N(); ++f)
             for(int type = 0; type < 2; ++type) {
-                std::map<State, State> mapping;
-                for(State state = 0; state < (1 << hloc.N()); ++state) {
-                    FlavorState const stateJ(state);
-                    FlavorState const stateI = type ? psiDagg(f, stateJ) : psi(f, stateJ);
-                    if(stateI.sign() != 0) {
-                        int const blockJ = pre_block_labels.label(stateJ.state());
-                        int const blockI = pre_block_labels.label(stateI.state());
+                State const bit = State(1) << f;
+                std::vector<State> mapping(preBlockNumber, size);
+                for(State state = 0; state < size; ++state)
+                    if(static_cast<bool>(state & bit) != static_cast<bool>(type)) {
+                        State const blockJ = pre_block_labels.label(state);
+                        State const blockI = pre_block_labels.label(state ^ bit);
                         
-                        if(mapping.count(blockJ))
+                        if(mapping[blockJ] != size)
                             block_labels.join(blockI, mapping[blockJ]);
                         else
                             mapping[blockJ] = blockI;
                     }
-                }
             }
        
                                                   
        blockStates.resize(block_labels.clean());
-       for(State state = 0; state < (1 << hloc.N()); ++state) 
+       for(State state = 0; state < size; ++state)
             blockStates[block_labels.label(pre_block_labels.label(state))].push_back(state);
     };
 
     
+    //block label and position in the block of each state, instead of searching the blocks
+    inline void get_state_indices(int N, BlockStates const& blockStates, std::vector<State>& labels, std::vector<State>& indices)
+    {
+        labels.assign(State(1) << N, blockStates.size()); indices.assign(State(1) << N, 0);
+        
+        for(State label = 0; label < blockStates.size(); ++label)
+            for(State index = 0; index < blockStates[label].size(); ++index) {
+                labels.at(blockStates[label][index]) = label; indices.at(blockStates[label][index]) = index;
+            }
+    };
+    
+    
     enum class Order { alternating, normal };
     
     
@@ -163,6 +286,9 @@ namespace ga {
                               bool const throw_error = true) //if false, instead return jsx::empty on error
     {
         jsx::value jObservable = jsx::array_t(blockStates.size());
+        
+        std::vector<State> labels, indices;
+        get_state_indices(tensor.N(), blockStates, labels, indices);
 
         State block_label = 0;
         for(auto const& blockState : blockStates) {
@@ -179,15 +305,13 @@ namespace ga {
                             FlavorState const stateI = psiDagg(f1, psi(f2, stateJ));
                             
                             if(stateI.sign() != 0) {
-                                auto it = std::find(blockState.begin(), blockState.end(), stateI.state());
-                                
-                                if(it == blockState.end()){
+                                if(labels[stateI.state()] != block_label){
                                     if (throw_error) throw std::runtime_error("Something is wrong with the partitioning of the states");
                                     else {mpi::cout << " not a good observable; removing from list ... " ; return jsx::empty();}
                                 }
                                 
                                 
-                                matrix(it - blockState.begin(), state_indexJ) += tensor.t(f1, f2)*static_cast<double>(stateI.sign());
+                                matrix(indices[stateI.state()], state_indexJ) += tensor.t(f1, f2)*static_cast<double>(stateI.sign());
                             }
                         }
                 
@@ -199,14 +323,12 @@ namespace ga {
                                     FlavorState const stateI = order == Order::normal ? psiDagg(f1, psiDagg(f2, psi(f3, psi(f4, stateJ)))) : psiDagg(f1, psi(f2, psiDagg(f3, psi(f4, stateJ))));
                                     
                                     if(stateI.sign() != 0) {
-                                        auto it = std::find(blockState.begin(), blockState.end(), stateI.state());
-                                        
-                                        if(it == blockState.end()){
+                                        if(labels[stateI.state()] != block_label){
                                             if (throw_error) throw std::runtime_error("Something is wrong with the partitioning of the states");
                                             else {mpi::cout << " not a good observable; removing from list ... " ; return jsx::empty();}
                                         }
                                         
-                                        matrix(it - blockState.begin(), state_indexJ) += tensor.V(f1, f2, f3, f4)*static_cast<double>(stateI.sign());
+                                        matrix(indices[stateI.state()], state_indexJ) += tensor.V(f1, f2, f3, f4)*static_cast<double>(stateI.sign());
                                     }
                                 }
                 ++state_indexJ;
@@ -220,34 +342,96 @@ namespace ga {
     };
 
     
+    //runs f(task) for the tasks on a number of threads, largest cost first
+    template<typename F>
+    void for_each_task(std::vector<double> const& costs, std::size_t numberOfThreads, F f)
+    {
+        std::vector<std::size_t> tasks(costs.size()); std::iota(tasks.begin(), tasks.end(), 0);
+        std::stable_sort(tasks.begin(), tasks.end(), [&](std::size_t lhs, std::size_t rhs) { return costs[lhs] > costs[rhs];});
+        
+        std::atomic<std::size_t> next(0);
+        std::vector<std::exception_ptr> errors(std::max<std::size_t>(std::min(numberOfThreads, tasks.size()), 1));
+        std::vector<std::thread> workers;
+        
+        for(std::size_t t = 0; t < errors.size(); ++t)
+            workers.emplace_back([&, t]() {
+                try {
+                    for(std::size_t n = next++; n < tasks.size(); n = next++) f(tasks[n]);
+                } catch(...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        
+        for(auto& worker : workers) worker.join();
+        
+        for(auto& error : errors)
+            if(error) std::rethrow_exception(error);
+    };
+    
+    
     template<typename Value>
-    jsx::value diagonalise(jsx::value& jHamiltonian)
+    jsx::value diagonalise(jsx::value& jHamiltonian, std::size_t numberOfThreads = 1)
     {
         jsx::value jEigenValues = jsx::array_t(jHamiltonian.size());
-
+        
+        std::vector<io::Matrix<Value>*> matrices; std::vector<io::rvec*> eigenValues; std::vector<double> costs;
         for(unsigned int sector = 0; sector < jHamiltonian.size(); ++sector) {
-            jEigenValues(sector) = io::rvec(jsx::at<io::Matrix<Value>>(jHamiltonian(sector)("matrix")).I());
-            linalg::eig('V', 'U', jsx::at<io::Matrix<Value>>(jHamiltonian(sector)("matrix")), jsx::at<io::rvec>(jEigenValues[sector]));
+            matrices.push_back(&jsx::at<io::Matrix<Value>>(jHamiltonian(sector)("matrix")));
+            jEigenValues(sector) = io::rvec(matrices.back()->I());
+            eigenValues.push_back(&jsx::at<io::rvec>(jEigenValues(sector)));
+            costs.push_back(std::pow(static_cast<double>(matrices.back()->I()), 3));
         }
         
+        for_each_task(costs, numberOfThreads, [&](std::size_t sector) {
+            linalg::eig('V', 'U', *matrices[sector], *eigenValues[sector]);
+        });
+        
         return jEigenValues;
     };
     
     
     template<typename Value>
-    void transform(jsx::value const& jTransformation,
-                   jsx::value& jOperator)
+    struct Transform {
+        io::Matrix<Value> const* start; io::Matrix<Value> const* target; io::Matrix<Value>* matrix;
+    };
+    
+    template<typename Value>
+    void add_transform(jsx::value const& jTransformation,
+                       jsx::value& jOperator,
+                       std::vector<Transform<Value>>& tasks)
     {
         for(std::size_t start = 0; start < jTransformation.size(); ++start)
             if(!jOperator(start)("target").is<jsx::null_t>()) {
                 auto const target = jOperator(start)("target").int64();
-                io::Matrix<Value> buffer(jsx::at<io::Matrix<Value>>(jOperator(start)("matrix")).I(), jsx::at<io::Matrix<Value>>(jOperator(start)("matrix")).J());
-                
-                linalg::mult<Value>('n', 'n', 1., jsx::at<io::Matrix<Value>>(jOperator(start)("matrix")), jsx::at<io::Matrix<Value>>(jTransformation(start)("matrix")), .0, buffer);
-                linalg::mult<Value>('c', 'n', 1., jsx::at<io::Matrix<Value>>(jTransformation(target)("matrix")), buffer, .0, jsx::at<io::Matrix<Value>>(jOperator(start)("matrix")));
+                tasks.push_back({&jsx::at<io::Matrix<Value>>(jTransformation(start)("matrix")), &jsx::at<io::Matrix<Value>>(jTransformation(target)("matrix")), &jsx::at<io::Matrix<Value>>(jOperator(start)("matrix"))});
             }
     };
     
+    template<typename Value>
+    void transform(std::vector<Transform<Value>> const& tasks, std::size_t numberOfThreads)
+    {
+        std::vector<double> costs;
+        for(auto const& task : tasks) costs.push_back(static_cast<double>(task.matrix->I())*task.matrix->J()*(task.matrix->I() + task.matrix->J()));
+        
+        for_each_task(costs, numberOfThreads, [&](std::size_t n) {
+            auto const& task = tasks[n];
+            io::Matrix<Value> buffer(task.matrix->I(), task.matrix->J());
+            
+            linalg::mult<Value>('n', 'n', 1., *task.matrix, *task.start, .0, buffer);
+            linalg::mult<Value>('c', 'n', 1., *task.target, buffer, .0, *task.matrix);
+        });
+    };
+    
+    template<typename Value>
+    void transform(jsx::value const& jTransformation,
+                   jsx::value& jOperator,
+                   std::size_t numberOfThreads = 1)
+    {
+        std::vector<Transform<Value>> tasks;
+        add_transform(jTransformation, jOperator, tasks);
+        transform(tasks, numberOfThreads);
+    };
+    
     
     template<typename Value>
     jsx::value get_annihilation_operators(int N,
@@ -255,11 +439,8 @@ namespace ga {
     {
         jsx::value jOperators = jsx::array_t(N, jsx::array_t(blockStates.size(), jsx::object_t{{"target", jsx::null_t()}}));
 
-        std::vector<State> block_labels(1 << N); State block_label = 0;
-        for(auto const& blockState : blockStates) {
-            for(auto const& state : blockState) block_labels[state] = block_label;
-            ++block_label;
-        }
+        std::vector<State> block_labels, indices;
+        get_state_indices(N, blockStates, block_labels, indices);
         
         State block_labelJ = 0;
         for(auto const& blockStateJ : blockStates) {
@@ -271,7 +452,7 @@ namespace ga {
                     if(stateI.sign() != 0) {
                         State const block_labelI = block_labels[stateI.state()];
                         auto const& blockStateI = blockStates[block_labelI];
-                        State const state_indexI = std::find(blockStateI.begin(), blockStateI.end(), stateI.state()) - blockStateI.begin();
+                        State const state_indexI = indices[stateI.state()];
                         
                         if(jOperators(f)(block_labelJ)("target").is<jsx::null_t>()) {
                             jOperators(f)(block_labelJ)("target") = jsx::int64_t(block_labelI);
@@ -326,13 +507,13 @@ namespace ga {
     //-----------------------------------------------------------------------------------------------------
     
     template<typename Value>
-    jsx::value construct_hloc(jsx::value jTensors, bool b64 = true)
+    jsx::value generate_hloc(jsx::value jTensors, std::size_t numberOfThreads)
     {
         jsx::value jHloc; Tensor<Value> hloc(jTensors);
         
         BlockStates blockStates;
         mpi::cout << "Number of invariant subspaces: " << std::flush;
-        find_blocks(hloc, blockStates);
+        find_blocks(hloc, blockStates, numberOfThreads);
         mpi::cout << blockStates.size() << std::endl;
         
         std::size_t maxDim = 0;
@@ -340,19 +521,18 @@ namespace ga {
         mpi::cout << "Dimension of the biggest subspace: " << maxDim << std::endl;
 
         jHloc["transformation"] = get_observable<Order::normal>(hloc, blockStates);
-        jHloc["eigen values"] = diagonalise<Value>(jHloc("transformation"));
+        jHloc["eigen values"] = diagonalise<Value>(jHloc("transformation"), numberOfThreads);
 
         jHloc["interaction"] = get_observable<Order::normal>(Tensor<Value>(hloc, typename Tensor<Value>::Interaction()), blockStates);
-        transform<Value>(jHloc("transformation"), jHloc("interaction"));
+        transform<Value>(jHloc("transformation"), jHloc("interaction"), numberOfThreads);
         
         jHloc["filling"] = get_sector_qn(blockStates, std::vector<double>(hloc.N(), 1.));
         
-        io::Matrix<Value> one_body(hloc.N(), hloc.N()); one_body.b64() = b64;
+        io::Matrix<Value> one_body(hloc.N(), hloc.N());
         for(int fDagger = 0; fDagger < hloc.N(); ++fDagger)
             for(int f = 0; f < hloc.N(); ++f)
                 one_body(fDagger, f) = hloc.t(fDagger, f);
         jHloc["one body"] = std::move(one_body);
-        jHloc["two body"] = jsx::at<io::Vector<Value>>(jTensors("two body"));
 
         jsx::array_t jBlockStates;
         for(auto const& states : blockStates) {
@@ -363,6 +543,67 @@ namespace ga {
         }
         jHloc["block states"] = std::move(jBlockStates);
         
+        return jHloc;
+    };
+    
+    
+    //key of the hloc cache, a hash of the interaction and the value type
+    template<typename Value>
+    std::string get_hloc_key(jsx::value const& jTensors)
+    {
+        std::ostringstream stream; stream << std::setprecision(std::numeric_limits<double>::max_digits10);
+        stream << io::Vector<Value>::name() << " " << io::binary::version << " "; jsx::write(jTensors, stream, 0);
+        
+        std::uint64_t hash = 14695981039346656037ull;   // fnv-1a
+        for(char const c : stream.str()) { hash ^= static_cast<unsigned char>(c); hash *= 1099511628211ull;}
+        
+        std::ostringstream key; key << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return key.str();
+    };
+    
+    //false if the cache does not exist or holds another hloc
+    inline bool read_hloc_cache(std::string const& name, std::string const& key, jsx::value& jHloc)
+    {
+        if(!std::ifstream(name.c_str())) return false;
+        
+        try {
+            jsx::value jCache = io::binary::read(name);
+            if(jCache("key").string() != key) return false;
+            jHloc = std::move(jCache("hloc"));
+        } catch(std::exception const& error) {
+            mpi::cout << "Ignoring hloc cache " << name << ": " << error.what() << std::endl;
+            return false;
+        }
+        
+        return true;
+    };
+    
+    //written to a temporary file first, such that other processes never read a partial cache
+    inline void write_hloc_cache(std::string const& name, std::string const& key, jsx::value const& jHloc)
+    {
+        if(mpi::rank() != mpi::master) return;
+        
+        std::string const temp = name + ".tmp";
+        io::binary::write(jsx::object_t{{"key", key}, {"hloc", jHloc}}, temp);
+        if(std::rename(temp.c_str(), name.c_str())) throw std::runtime_error("ga::write_hloc_cache: can not write " + name);
+    };
+    
+    
+    template<typename Value>
+    jsx::value construct_hloc(jsx::value jTensors, bool b64 = true, std::size_t numberOfThreads = 1, std::string const& cache = "")
+    {
+        jsx::value jHloc; std::string const key = cache.size() ? get_hloc_key<Value>(jTensors) : "";
+        
+        if(cache.size() && read_hloc_cache(cache, key, jHloc))
+            mpi::cout << "Read hloc from cache " << cache << std::endl;
+        else {
+            jHloc = generate_hloc<Value>(jTensors, numberOfThreads);
+            if(cache.size()) write_hloc_cache(cache, key, jHloc);
+        }
+        
+        jHloc["two body"] = jsx::at<io::Vector<Value>>(jTensors("two body"));
+        
+        jsx::at<io::Matrix<Value>>(jHloc("one body")).b64() = b64;
         jsx::at<io::rvec>(jHloc("filling")).b64() = b64;
         for(auto& jBlock : jHloc("eigen values").array())   jsx::at<io::rvec>(jBlock).b64() = b64;
         for(auto& jBlock : jHloc("transformation").array()) jsx::at<io::Matrix<Value>>(jBlock("matrix")).b64() = b64;
@@ -371,13 +612,35 @@ namespace ga {
         return jHloc;
     };
     
-    
     //-----------------------------------------------------------------------------------------------------
     
+    //Every process maps the file, and the eigen values and matrices are decoded directly from it (c.f. io/Mapped.h)
     template<typename Value>
     jsx::value read_hloc(std::string const name)
     {
-        jsx::value jHloc = mpi::read(name);
+        io::Mapped const file(name); jsx::value jHloc = jsx::object_t();
+        
+        for(auto const& entry : file.root().object()) {
+            if(entry.first == "one body")
+                jHloc[entry.first] = entry.second.get<io::Matrix<Value>>();
+            else if(entry.first == "filling")
+                jHloc[entry.first] = entry.second.get<io::rvec>();
+            else if(entry.first == "eigen values") {
+                jsx::array_t jBlocks;
+                for(auto const& block : entry.second.array()) jBlocks.push_back(block.get<io::rvec>());
+                jHloc[entry.first] = std::move(jBlocks);
+            } else if(entry.first == "transformation" || entry.first == "interaction") {
+                jsx::array_t jBlocks;
+                for(auto const& block : entry.second.array()) {
+                    jsx::value jBlock = jsx::object_t();
+                    for(auto const& blockEntry : block.object())
+                        jBlock[blockEntry.first] = blockEntry.first == "matrix" && blockEntry.second.is_array() ? jsx::value(blockEntry.second.get<io::Matrix<Value>>()) : blockEntry.second.value();
+                    jBlocks.push_back(std::move(jBlock));
+                }
+                jHloc[entry.first] = std::move(jBlocks);
+            } else
+                jHloc[entry.first] = entry.second.value();
+        }
         
         if(jsx::at<io::Matrix<Value>>(jHloc("one body")).I() != jsx::at<io::Matrix<Value>>(jHloc("one body")).J())
             throw std::runtime_error("ga::real_hloc: one body matrix not square");
@@ -434,11 +697,13 @@ namespace ga {
     };
     
     template<typename Value>
-    jsx::value construct_annihilation_operators(jsx::value const& jHloc)
+    jsx::value construct_annihilation_operators(jsx::value const& jHloc, std::size_t numberOfThreads = 1)
     {
         jsx::value jOperators = get_annihilation_operators<Value>(jsx::at<io::Matrix<Value>>(jHloc("one body")).I(), get_block_states(jHloc));
         
-        for(auto& jOperator : jOperators.array()) transform<Value>(jHloc("transformation"), jOperator);
+        std::vector<Transform<Value>> tasks;
+        for(auto& jOperator : jOperators.array()) add_transform(jHloc("transformation"), jOperator, tasks);
+        transform(tasks, numberOfThreads);
         
         return jOperators;
     };
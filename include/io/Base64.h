@@ -82,17 +82,23 @@ namespace base64 {
     
     
     template<typename T>
-    void decode(std::string const& source, std::vector<T>& dest) {
-        dest.resize((6*source.size())/(8*sizeof(T)));
+    void decode(char const* source, char const* end, std::vector<T>& dest) {
+        std::size_t const size = end - source;
+        dest.resize((6*size)/(8*sizeof(T)));
         
-        if(!(6*source.size() - 8*sizeof(T)*dest.size() < 6)) throw std::runtime_error("base64::decode: too much padding bits");
+        if(!(6*size - 8*sizeof(T)*dest.size() < 6)) throw std::runtime_error("base64::decode: too much padding bits");
         
         dest.push_back(T()); auto const begin = reinterpret_cast<unsigned char*>(dest.data()); Dictionary dict;
         
-        for(std::size_t index = 0; index < source.size(); ++index) set_six_at(dict.decode(source[index]), begin, 6*index);
+        for(std::size_t index = 0; index < size; ++index) set_six_at(dict.decode(source[index]), begin, 6*index);
         
         dest.pop_back(); endian::Little<T> as_little; for(auto& x : dest) as_little.read(x);
     };
+    
+    template<typename T>
+    void decode(std::string const& source, std::vector<T>& dest) {
+        decode(source.data(), source.data() + source.size(), dest);
+    };
 };
 
 #endif
@@ -0,0 +1,211 @@
+#ifndef INCLUDE_IO_BINARY_H
+#define INCLUDE_IO_BINARY_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <deque>
+
+#include "Endian.h"
+#include "Tag.h"
+#include "Vector.h"
+#include "Matrix.h"
+#include "../JsonX.h"
+
+//Binary container for measurement trees. Layout:
+//
+//  "CTQMCBIN" | version (uint64) | size of the index (uint64) | index | padding to 8 bytes | data
+//
+//The index is the json tree with the vectors (io::ivec, io::rvec, io::cvec, also when tagged) replaced by {"io::binary": [type, offset, size]},
+//where offset is the byte offset from the start of the data and size the number of elements, and the matrices (io::rmat, io::cmat)
+//by {"io::binary": [type, offset, size, I, J]}. The data are the raw vectors in little
+//endian, integers as int64, complex numbers as (real, imag) pairs, each vector aligned to 8 bytes, so the file can also be mapped into memory as is.
+
+namespace io {
+
+    namespace binary {
+
+        char const magic[] = "CTQMCBIN";
+        std::uint64_t const version = 1;
+
+
+        //the elements are stored as doubles (complex numbers as two) or as 64 bit integers
+        template<typename T> struct Scalar { using type = double;};
+        template<> struct Scalar<std::int64_t> { using type = std::int64_t;};
+
+        struct Leaf {
+            void const* data; std::size_t size; bool integral;   // size in scalars
+        };
+
+        template<typename T>
+        inline void add_leaf(T const* data, std::size_t size, std::uint64_t& offset, std::vector<Leaf>& leafs) {
+            using S = typename Scalar<T>::type; std::size_t const scalars = sizeof(T)/sizeof(S);
+            leafs.push_back({ data, scalars*size, std::is_same<S, std::int64_t>::value });
+            offset += sizeof(S)*scalars*size;
+        };
+
+
+        template<typename T>
+        inline jsx::value index(Vector<T> const& vec, std::uint64_t& offset, std::vector<Leaf>& leafs) {
+            jsx::value jIndex = jsx::object_t{{ "io::binary", jsx::array_t{ Vector<T>::name(), static_cast<std::int64_t>(offset), static_cast<std::int64_t>(vec.size()) }}};
+            add_leaf(vec.data(), vec.size(), offset, leafs);
+            return jIndex;
+        };
+
+        template<typename T>
+        inline jsx::value index(Matrix<T> const& mat, std::uint64_t& offset, std::vector<Leaf>& leafs) {
+            jsx::value jIndex = jsx::object_t{{ "io::binary", jsx::array_t{ Matrix<T>::name(), static_cast<std::int64_t>(offset), static_cast<std::int64_t>(mat.I())*mat.J(), static_cast<std::int64_t>(mat.I()), static_cast<std::int64_t>(mat.J()) }}};
+            add_leaf(mat.data(), static_cast<std::size_t>(mat.I())*mat.J(), offset, leafs);
+            return jIndex;
+        };
+
+        //the vectors of jArg stay referenced by leafs, tagged vectors are decoded into temps
+        inline jsx::value index(jsx::value const& jArg, std::uint64_t& offset, std::vector<Leaf>& leafs, std::deque<jsx::value>& temps) {
+            if(jArg.is<ivec>()) return index(jArg.at<ivec>(), offset, leafs);
+            if(jArg.is<rvec>()) return index(jArg.at<rvec>(), offset, leafs);
+            if(jArg.is<cvec>()) return index(jArg.at<cvec>(), offset, leafs);
+            if(jArg.is<rmat>()) return index(jArg.at<rmat>(), offset, leafs);
+            if(jArg.is<cmat>()) return index(jArg.at<cmat>(), offset, leafs);
+
+            if(jArg.is<jsx::object_t>()) {
+                if(jArg.size() == 1 && (jArg.is(rvec::name()) || jArg.is(cvec::name()))) {
+                    temps.push_back(jArg); from_tagged_json(temps.back());
+                    return index(temps.back(), offset, leafs, temps);
+                }
+
+                jsx::value jIndex = jsx::object_t();
+                for(auto const& jEntry : jArg.object()) jIndex[jEntry.first] = index(jEntry.second, offset, leafs, temps);
+                return jIndex;
+            }
+
+            if(jArg.is<jsx::array_t>()) {
+                jsx::value jIndex = jsx::array_t();
+                for(auto const& jEntry : jArg.array()) jIndex.array().push_back(index(jEntry, offset, leafs, temps));
+                return jIndex;
+            }
+
+            if(!jArg.is_json()) throw std::runtime_error("io::binary::write: " + jArg.name() + " not allowed");
+
+            return jArg;
+        };
+
+
+        template<typename T>
+        inline void write_little(std::ostream& stream, T const* data, std::size_t size) {
+            endian::Little<T> const little; std::vector<T> buffer(std::min<std::size_t>(size, 1 << 13));
+
+            for(std::size_t begin = 0; begin < size; begin += buffer.size()) {
+                std::size_t const n = std::min(buffer.size(), size - begin);
+                std::copy(data + begin, data + begin + n, buffer.begin());
+                if(!little.native()) for(std::size_t i = 0; i < n; ++i) little.write(buffer[i]);
+                stream.write(reinterpret_cast<char const*>(buffer.data()), n*sizeof(T));
+            }
+        };
+
+        template<typename T>
+        inline void read_little(std::istream& stream, T* data, std::size_t size) {
+            endian::Little<T> const little;
+
+            stream.read(reinterpret_cast<char*>(data), size*sizeof(T));
+            if(!little.native()) for(std::size_t i = 0; i < size; ++i) little.read(data[i]);
+        };
+
+
+        inline void write(jsx::value const& jArg, std::string const& name) {
+            std::uint64_t offset = 0; std::vector<Leaf> leafs; std::deque<jsx::value> temps;
+
+            std::ostringstream index; index << std::setprecision(std::numeric_limits<double>::max_digits10);
+            jsx::write(binary::index(jArg, offset, leafs, temps), index, 0);
+
+            std::string const text = index.str();
+            std::uint64_t const header[] = { version, text.size() };
+            std::size_t const padding = (8 - (sizeof(magic) - 1 + sizeof(header) + text.size())%8)%8;
+
+            std::ofstream file(name.c_str(), std::ios::binary);
+            if(!file) throw std::runtime_error("io::binary::write: can not open file " + name);
+
+            file.write(magic, sizeof(magic) - 1);
+            write_little(file, header, 2);
+            file.write(text.data(), text.size());
+            file.write("\0\0\0\0\0\0\0", padding);
+
+            for(auto const& leaf : leafs)
+                leaf.integral ? write_little(file, static_cast<std::int64_t const*>(leaf.data), leaf.size) : write_little(file, static_cast<double const*>(leaf.data), leaf.size);
+
+            if(!file) throw std::runtime_error("io::binary::write: error while writing file " + name);
+        };
+
+
+        //Reads the vectors at the positions given by the index
+        template<typename T>
+        inline jsx::value read(std::istream& stream, std::uint64_t begin, std::uint64_t offset, std::size_t size, bool b64) {
+            Vector<T> vec(size); vec.b64() = b64;
+            stream.seekg(begin + offset);
+            using S = typename Scalar<T>::type; read_little(stream, reinterpret_cast<S*>(vec.data()), sizeof(T)/sizeof(S)*size);
+            return std::move(vec);
+        };
+
+        template<typename T>
+        inline jsx::value read(std::istream& stream, std::uint64_t begin, std::uint64_t offset, std::size_t I, std::size_t J, bool b64) {
+            Matrix<T> mat(I, J); mat.b64() = b64;
+            stream.seekg(begin + offset);
+            using S = typename Scalar<T>::type; read_little(stream, reinterpret_cast<S*>(mat.data()), sizeof(T)/sizeof(S)*I*J);
+            return std::move(mat);
+        };
+
+        inline void read(jsx::value& jArg, std::istream& stream, std::uint64_t begin, bool b64) {
+            if(jArg.is<jsx::object_t>()) {
+                if(jArg.size() == 1 && jArg.is("io::binary")) {
+                    jsx::value const jLeaf = jArg("io::binary");
+
+                    if(jLeaf(0).string() == ivec::name())
+                        jArg = read<std::int64_t>(stream, begin, jLeaf(1).int64(), jLeaf(2).int64(), b64);
+                    else if(jLeaf(0).string() == rvec::name())
+                        jArg = read<double>(stream, begin, jLeaf(1).int64(), jLeaf(2).int64(), b64);
+                    else if(jLeaf(0).string() == cvec::name())
+                        jArg = read<std::complex<double>>(stream, begin, jLeaf(1).int64(), jLeaf(2).int64(), b64);
+                    else if(jLeaf(0).string() == rmat::name())
+                        jArg = read<double>(stream, begin, jLeaf(1).int64(), jLeaf(3).int64(), jLeaf(4).int64(), b64);
+                    else if(jLeaf(0).string() == cmat::name())
+                        jArg = read<std::complex<double>>(stream, begin, jLeaf(1).int64(), jLeaf(3).int64(), jLeaf(4).int64(), b64);
+                    else
+                        throw std::runtime_error("io::binary::read: invalid type " + jLeaf(0).string());
+                } else
+                    for(auto& jEntry : jArg.object()) read(jEntry.second, stream, begin, b64);
+            } else if(jArg.is<jsx::array_t>())
+                for(auto& jEntry : jArg.array()) read(jEntry, stream, begin, b64);
+        };
+
+
+        //Returns the tree with io::rvec, io::cvec (and io::rmat, io::cmat) values, as after io::from_tagged_json for the json measurements (b64 = true to write them as these)
+        inline jsx::value read(std::string const& name, bool b64 = false) {
+            std::ifstream file(name.c_str(), std::ios::binary);
+            if(!file) throw std::runtime_error("io::binary::read: file " + name + " not found !");
+
+            char tag[sizeof(magic) - 1]; std::uint64_t header[2];
+            file.read(tag, sizeof(tag)); read_little(file, header, 2);
+            if(!file || std::memcmp(tag, magic, sizeof(tag))) throw std::runtime_error("io::binary::read: " + name + " is not a binary measurement file");
+            if(header[0] != version) throw std::runtime_error("io::binary::read: " + name + " has unknown version");
+
+            std::string text(header[1] + 1, '\0'); file.read(&text.front(), header[1]);
+            if(!file) throw std::runtime_error("io::binary::read: " + name + " is truncated");
+
+            jsx::value jArg;
+            if(*jsx::parse(&text.front(), jArg) != '\0') throw std::runtime_error("io::binary::read: invalid index in " + name);
+
+            std::uint64_t const begin = sizeof(tag) + sizeof(header) + header[1] + (8 - (sizeof(tag) + sizeof(header) + header[1])%8)%8;
+            read(jArg, file, begin, b64);
+
+            if(!file) throw std::runtime_error("io::binary::read: " + name + " is truncated");
+
+            return jArg;
+        };
+
+    };
+
+};
+
+#endif
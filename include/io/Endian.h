@@ -55,7 +55,12 @@ namespace endian {
             
             for(std::size_t i = 0; i < sizeof(T); ++i) arg_ptr[i] = tmp_ptr[map(i)];
         };
-        
+
+        bool native() const {   // read and write do nothing
+            for(std::size_t i = 0; i < sizeof(T); ++i) if(map(i) != i) return false;
+            return true;
+        };
+
     private:
         T const key_ = Key<T>::get();
         
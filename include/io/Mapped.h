@@ -0,0 +1,261 @@
+#ifndef INCLUDE_IO_MAPPED_H
+#define INCLUDE_IO_MAPPED_H
+
+#include <vector>
+#include <string>
+#include <complex>
+#include <algorithm>
+#include <stdexcept>
+#include <cctype>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Base64.h"
+#include "Vector.h"
+#include "Matrix.h"
+#include "../JsonX.h"
+
+//Read only json file mapped into memory. The file is scanned once for the matching brackets of all objects and arrays, afterwards entries
+//are looked up without parsing the values in between, and only the accessed subtrees are parsed (into jsx::value), or decoded directly
+//from the file (base64 or plain arrays into io::Vector and io::Matrix).
+//
+//The file is mapped onto a zero page one past its end, such that the text is terminated as jsx::parse expects.
+
+namespace io {
+
+    struct Mapped {
+        struct Entry;
+
+        Mapped() = delete;
+        explicit Mapped(std::string const& name) : name_(name) {
+            int const fd = open(name.c_str(), O_RDONLY);
+            if(fd < 0) throw std::runtime_error("io::Mapped: file " + name + " not found !");
+
+            struct stat info;
+            if(fstat(fd, &info) < 0) { close(fd); throw std::runtime_error("io::Mapped: can not stat " + name);};
+            size_ = info.st_size;
+
+            std::size_t const page = sysconf(_SC_PAGESIZE);
+            length_ = (size_ + 1 + page - 1)/page*page;
+
+            void* base = mmap(nullptr, length_, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(base == MAP_FAILED) { close(fd); throw std::runtime_error("io::Mapped: can not map " + name);};
+
+            if(size_ && mmap(base, size_, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                munmap(base, length_); close(fd); throw std::runtime_error("io::Mapped: can not map " + name);
+            }
+            close(fd);
+
+            data_ = static_cast<char const*>(base);
+
+            index();
+        };
+        Mapped(Mapped const&) = delete;
+        Mapped(Mapped&&) = delete;
+        Mapped& operator=(Mapped const&) = delete;
+        Mapped& operator=(Mapped&&) = delete;
+        ~Mapped() { munmap(const_cast<char*>(data_), length_);};
+
+        Entry root() const;
+
+    private:
+        std::string const name_;
+        std::size_t size_, length_;
+        char const* data_;
+
+        std::vector<std::size_t> open_, close_;  // positions of the brackets, open_ is sorted
+
+        void index() {
+            std::vector<std::size_t> stack;
+
+            for(std::size_t pos = 0; pos < size_; ++pos)
+                switch(data_[pos]) {
+                    case '\"':
+                        pos = string_end(data_ + pos + 1) - data_;
+                        break;
+                    case '{': case '[':
+                        stack.push_back(open_.size()); open_.push_back(pos); close_.push_back(0);
+                        break;
+                    case '}': case ']':
+                        if(stack.empty() || data_[open_[stack.back()]] != (data_[pos] == '}' ? '{' : '[')) throw std::runtime_error("io::Mapped: brackets do not match in " + name_);
+                        close_[stack.back()] = pos; stack.pop_back();
+                        break;
+                }
+
+            if(stack.size()) throw std::runtime_error("io::Mapped: brackets do not match in " + name_);
+        };
+
+        //closing quote of the string starting at it (after the opening quote), quotes preceded by an odd number of backslashes are escaped
+        char const* string_end(char const* it) const {
+            while(true) {
+                it = static_cast<char const*>(std::memchr(it, '\"', data_ + size_ - it));
+                if(it == nullptr) throw std::runtime_error("io::Mapped: unterminated string in " + name_);
+                
+                char const* back = it; while(*(back - 1) == '\\') --back;
+                if((it - back)%2 == 0) return it;
+                ++it;
+            }
+        };
+
+        char const* skip_white_space(char const* it) const {
+            while(it < data_ + size_ && std::isspace(static_cast<unsigned char>(*it))) ++it;
+            return it;
+        };
+
+        //first character after the value at it
+        char const* end(char const* it) const {
+            if(*it == '{' || *it == '[')
+                return data_ + close_[std::lower_bound(open_.begin(), open_.end(), it - data_) - open_.begin()] + 1;
+
+            if(*it == '\"') return string_end(it + 1) + 1;
+
+            while(it < data_ + size_ && *it != ',' && *it != ']' && *it != '}' && !std::isspace(static_cast<unsigned char>(*it))) ++it;
+            return it;
+        };
+
+        //calls f(key, value) for the entries of an object, and f(std::string(), value) for those of an array
+        template<typename F>
+        void for_each(char const* it, F f) const {
+            char const close = *it == '{' ? '}' : ']'; bool const object = *it == '{';
+
+            it = skip_white_space(++it);
+            while(*it != close) {
+                std::string key;
+                if(object) {
+                    char const* const begin = it + 1; it = end(it); key.assign(begin, it - 1);
+                    it = skip_white_space(it);
+                    if(*it != ':') throw std::runtime_error("io::Mapped: no object value found in " + name_);
+                    it = skip_white_space(++it);
+                }
+
+                char const* const value = it; it = skip_white_space(end(it));
+                if(!f(key, value)) return;
+
+                if(*it == ',') it = skip_white_space(++it);
+                else if(*it != close) throw std::runtime_error("io::Mapped: invalid format in " + name_);
+            }
+        };
+    };
+
+
+    struct Mapped::Entry {
+        Entry() = delete;
+        Entry(Mapped const& file, char const* begin) : file_(&file), begin_(begin) {};
+        Entry(Entry const&) = default;
+        Entry(Entry&&) = default;
+        Entry& operator=(Entry const&) = default;
+        Entry& operator=(Entry&&) = default;
+        ~Entry() = default;
+
+        bool is_object() const { return *begin_ == '{';};
+        bool is_array() const { return *begin_ == '[';};
+        bool is_string() const { return *begin_ == '\"';};
+
+        std::size_t size() const {
+            if(!(is_object() || is_array())) throw std::runtime_error("io::Mapped::Entry: size request for non-container in " + file_->name_);
+            std::size_t size = 0; file_->for_each(begin_, [&](std::string const&, char const*) { ++size; return true;});
+            return size;
+        };
+
+        bool is(std::string const& key) const {
+            return find(key) != nullptr;
+        };
+        Entry operator()(std::string const& key) const {
+            char const* const value = find(key);
+            if(value == nullptr) throw std::runtime_error("io::Mapped::Entry: key \"" + key + "\" not found in " + file_->name_);
+            return Entry(*file_, value);
+        };
+        Entry operator()(std::size_t index) const {
+            if(!is_array()) throw std::runtime_error("io::Mapped::Entry: index request for non-array in " + file_->name_);
+            char const* value = nullptr;
+            file_->for_each(begin_, [&](std::string const&, char const* it) { if(index--) return true; value = it; return false;});
+            if(value == nullptr) throw std::runtime_error("io::Mapped::Entry: invalid array index in " + file_->name_);
+            return Entry(*file_, value);
+        };
+
+        std::vector<std::pair<std::string, Entry>> object() const {
+            if(!is_object()) throw std::runtime_error("io::Mapped::Entry: object request for non-object in " + file_->name_);
+            std::vector<std::pair<std::string, Entry>> entries;
+            file_->for_each(begin_, [&](std::string const& key, char const* it) { entries.push_back({key, Entry(*file_, it)}); return true;});
+            return entries;
+        };
+        std::vector<Entry> array() const {
+            if(!is_array()) throw std::runtime_error("io::Mapped::Entry: array request for non-array in " + file_->name_);
+            std::vector<Entry> entries;
+            file_->for_each(begin_, [&](std::string const&, char const* it) { entries.push_back(Entry(*file_, it)); return true;});
+            return entries;
+        };
+
+        //parses the subtree
+        jsx::value value() const {
+            jsx::value value; jsx::parse(begin_, value);
+            return value;
+        };
+
+        //same as jsx::at<T>(value()), but base64 strings are decoded directly from the file
+        template<typename T>
+        T get() const {
+            T value; read(value);
+            return value;
+        };
+
+    private:
+        Mapped const* file_;
+        char const* begin_;
+
+        char const* find(std::string const& key) const {
+            if(!is_object()) throw std::runtime_error("io::Mapped::Entry: key request for non-object in " + file_->name_);
+            char const* value = nullptr;
+            file_->for_each(begin_, [&](std::string const& entry, char const* it) { if(entry != key) return true; value = it; return false;});
+            return value;
+        };
+
+        template<typename T>
+        void read(T& value) const {
+            value.read(this->value());
+        };
+
+        void read(Vector<double>& value) const {
+            if(is_string())
+                base64::decode(begin_ + 1, file_->end(begin_) - 1, value);
+            else
+                value.read(this->value());
+        };
+
+        void read(Vector<std::complex<double>>& value) const {
+            Vector<double> const real = operator()("real").get<Vector<double>>();
+            Vector<double> const imag = operator()("imag").get<Vector<double>>();
+
+            if(real.size() != imag.size()) throw std::runtime_error("io::Mapped::Entry: invalid format in " + file_->name_);
+
+            value.resize(real.size());
+            for(std::size_t n = 0; n < real.size(); ++n) value[n] = {real[n], imag[n]};
+        };
+
+        template<typename T>
+        void read(Matrix<T>& value) const {
+            std::vector<Entry> const entries = array();
+            if(entries.size() != 3) throw std::runtime_error("io::Mapped::Entry: invalid matrix format in " + file_->name_);
+
+            Vector<T> const data = entries[2].get<Vector<T>>();
+            value.resize(entries[0].value().int64(), entries[1].value().int64());
+
+            if(data.size() != static_cast<std::size_t>(value.I())*value.J()) throw std::runtime_error("io::Mapped::Entry: invalid matrix size in " + file_->name_);
+            std::copy(data.begin(), data.end(), value.data());
+        };
+    };
+
+
+    inline Mapped::Entry Mapped::root() const {
+        char const* const begin = skip_white_space(data_);
+        if(begin == data_ + size_) throw std::runtime_error("io::Mapped: file " + name_ + " is empty");
+        return Entry(*this, begin);
+    };
+
+}
+
+#endif
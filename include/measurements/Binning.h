@@ -0,0 +1,203 @@
+#ifndef INCLUDE_MEASUREMENTS_BINNING_H
+#define INCLUDE_MEASUREMENTS_BINNING_H
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+
+#include "../JsonX.h"
+#include "../io/Vector.h"
+
+//Logarithmic binning of the stores of a measurement vector, c.f. Wolff, Comput. Phys. Commun. 156, 143 (2004) or the ALPS binning analysis.
+//
+//Each store (sum of its samples divided by their number) is one entry of level 0, and two consecutive bins of level l form one bin of
+//level l + 1. The error of the mean estimated from the bins of level l grows with l until the bins are longer than the autocorrelation
+//time, tau = (err_l^2/err_0^2 - 1)/2 is the integrated autocorrelation time in units of stores. Complex entries are binned component-wise.
+//
+//Each Markov chain bins its stores separately (c.f. meas::chain), since the bins of interleaved time series would be meaningless.
+
+namespace meas {
+
+    //Set before the Markov chains are run ("binning" : true), the stores of the restart measurements are thus not binned
+    inline bool& binning() { static bool binning = false; return binning;};
+
+    //Id of the Markov chain whose stores are binned, set on each thread by mc::Simulations before it advances a chain (stores with -1 are not binned)
+    inline std::int64_t& chain() { static thread_local std::int64_t chain = 0; return chain;};
+
+
+    template<typename T>
+    struct Binning {
+        Binning() = default;
+        Binning(Binning const&) = default;
+        Binning(Binning&&) = default;
+        Binning& operator=(Binning const&) = default;
+        Binning& operator=(Binning&&) = default;
+        ~Binning() = default;
+
+        void add(T const* val, std::size_t size, double norm) {
+            auto& bin = bin_;  bin.assign(val, val + size);  for(auto& x : bin) x *= norm;
+
+            for(std::size_t l = 0; ; ++l) {
+                if(l == levels_.size()) levels_.emplace_back(size);
+                auto& level = levels_[l];
+
+                ++level.count;
+                for(std::size_t i = 0; i < size; ++i) {
+                    level.sum[i] += bin[i]; level.square[i] += square(bin[i]);
+                }
+
+                if(!level.pending) {
+                    level.partial = bin; level.pending = true; return;
+                }
+
+                for(std::size_t i = 0; i < size; ++i) bin[i] = (level.partial[i] + bin[i])/2.;
+                level.pending = false;
+            }
+        };
+
+        //Pools the bins of another Markov chain level by level, the unfinished bins of other are dropped
+        void add(Binning const& other) {
+            for(std::size_t l = 0; l < other.levels_.size(); ++l) {
+                auto const& source = other.levels_[l];
+                if(l == levels_.size()) levels_.emplace_back(source.sum.size());
+                auto& level = levels_[l];
+
+                level.count += source.count;
+                for(std::size_t i = 0; i < source.sum.size(); ++i) {
+                    level.sum[i] += source.sum[i]; level.square[i] += source.square[i];
+                }
+            }
+        };
+
+
+        std::size_t levels() const { return levels_.size();};
+
+        //Number of doubles of pack for levels levels of size entries
+        static std::size_t packed(std::size_t levels, std::size_t size) { return levels*(1 + 2*sizeof(T)/sizeof(double)*size);};
+
+        //The count of each level, then the sums and squares of level l at levels + 2*l*block and levels + (2*l + 1)*block, with block the
+        //number of doubles of size entries. Levels beyond those of this binning are zero. The packs of several binnings (e.g. on all ranks)
+        //can be summed, c.f. meas::BinningReduce.
+        void pack(std::size_t levels, std::size_t size, double* dest) const {
+            std::size_t const block = sizeof(T)/sizeof(double)*size;
+            std::fill_n(dest, packed(levels, size), .0);
+
+            for(std::size_t l = 0; l < levels_.size(); ++l) {
+                dest[l] = levels_[l].count;
+                std::copy_n(reinterpret_cast<double const*>(levels_[l].sum.data()), block, dest + levels + 2*l*block);
+                std::copy_n(reinterpret_cast<double const*>(levels_[l].square.data()), block, dest + levels + (2*l + 1)*block);
+            }
+        };
+
+        //Returns {"error": .., "tau": .., "level": l, "bins": n} for the largest level of the pack with at least minBins() bins, with the error
+        //multiplied by fact, or null if there are less than two stores
+        static jsx::value result(double const* packed, std::size_t levels, std::size_t size, double fact) {
+            std::size_t const block = sizeof(T)/sizeof(double)*size;
+            if(!levels || packed[0] < 2) return jsx::null_t();
+
+            auto const count = [&](std::size_t l) { return static_cast<std::int64_t>(packed[l]);};
+            double const* const sums = packed + levels;
+
+            std::size_t level = 0;
+            while(level + 1 < levels && count(level + 1) >= minBins()) ++level;
+
+            io::Vector<T> error(size), tau(size);
+            double* const err = reinterpret_cast<double*>(error.data()); double* const t = reinterpret_cast<double*>(tau.data());
+
+            for(std::size_t i = 0; i < block; ++i) {
+                double const err0 = variance(count(0), sums[i], sums[block + i]);
+                double const errL = variance(count(level), sums[2*level*block + i], sums[(2*level + 1)*block + i]);
+
+                err[i] = fact*std::sqrt(errL);
+                t[i] = err0 > .0 ? (errL/err0 - 1.)/2. : .0;
+            }
+
+            return jsx::object_t{
+                { "error", std::move(error) },
+                { "tau",   std::move(tau) },
+                { "level", static_cast<std::int64_t>(level) },
+                { "bins",  count(level) }
+            };
+        };
+
+        //Analysis of the bins of this rank only (no mpi), c.f. result
+        jsx::value analyse_local(double fact, std::size_t size) const {
+            std::vector<double> sums(packed(levels_.size(), size)); pack(levels_.size(), size, sums.data());
+            return result(sums.data(), levels_.size(), size, fact);
+        };
+
+
+        //{"count": [n_l], "pending": [0/1], "sum", "square", "partial": [level 0, level 1, ...]}, for the checkpoints
+        jsx::value json() const {
+            io::ivec count, pending; io::Vector<T> sum, square, partial;
+            for(auto const& level : levels_) {
+                count.push_back(level.count); pending.push_back(level.pending);
+                sum.insert(sum.end(), level.sum.begin(), level.sum.end());
+                square.insert(square.end(), level.square.begin(), level.square.end());
+                partial.insert(partial.end(), level.partial.begin(), level.partial.end());
+            }
+
+            return jsx::object_t{
+                { "count", std::move(count) }, { "pending", std::move(pending) },
+                { "sum", std::move(sum) }, { "square", std::move(square) }, { "partial", std::move(partial) }
+            };
+        };
+
+        void restore(jsx::value const& jBinning, std::size_t size) {
+            auto const& count = jsx::at<io::ivec>(jBinning("count")); auto const& pending = jsx::at<io::ivec>(jBinning("pending"));
+            auto const& sum = jsx::at<io::Vector<T>>(jBinning("sum"));
+            auto const& square = jsx::at<io::Vector<T>>(jBinning("square"));
+            auto const& partial = jsx::at<io::Vector<T>>(jBinning("partial"));
+
+            levels_.clear();
+            for(std::size_t l = 0; l < count.size(); ++l) {
+                levels_.emplace_back(size);
+                levels_.back().count = count[l]; levels_.back().pending = pending[l];
+                std::copy_n(sum.begin() + l*size, size, levels_.back().sum.begin());
+                std::copy_n(square.begin() + l*size, size, levels_.back().square.begin());
+                std::copy_n(partial.begin() + l*size, size, levels_.back().partial.begin());
+            }
+        };
+
+        //Local (no mpi) estimate of the autocorrelation time of the component i (in doubles), or -1 as long as level 1 has less than minBins() bins
+        double tau(std::size_t i) const {
+            if(levels_.size() < 2 || levels_[1].count < minBins()) return -1.;
+
+            std::size_t level = 1;
+            while(level + 1 < levels_.size() && levels_[level + 1].count >= minBins()) ++level;
+
+            double const err0 = variance(levels_[0].count, component(levels_[0].sum, i), component(levels_[0].square, i));
+            double const errL = variance(levels_[level].count, component(levels_[level].sum, i), component(levels_[level].square, i));
+
+            return err0 > .0 ? std::max((errL/err0 - 1.)/2., .0) : .0;
+        };
+
+        static std::int64_t minBins() { return 32;};
+
+    private:
+        struct Level {
+            explicit Level(std::size_t size) : sum(size, .0), square(size, .0), partial(size, .0) {};
+            std::int64_t count = 0; bool pending = false;
+            std::vector<T> sum, square, partial;
+        };
+
+        std::vector<Level> levels_;
+        std::vector<T> bin_;
+
+        static double component(std::vector<T> const& vec, std::size_t i) { return reinterpret_cast<double const*>(vec.data())[i];};
+
+        static double square(double x) { return x*x;};
+        static std::complex<double> square(std::complex<double> const& z) { return { z.real()*z.real(), z.imag()*z.imag()};};
+
+        //variance of the mean of n bins
+        static double variance(std::int64_t n, double sum, double square) {
+            double const mean = sum/n;
+            return std::max(square/n - mean*mean, .0)/(n - 1);
+        };
+    };
+
+}
+
+#endif
@@ -7,10 +7,16 @@
 #include <valarray>
 #include <cstring>
 #include <random>
+#include <map>
+#include <set>
+#include <sstream>
+#include <iomanip>
 
 #include "../JsonX.h"
 #include "../mpi/Utilities.h"
 #include "../io/Vector.h"
+#include "../io/Binary.h"
+#include "Binning.h"
 #include "../../ctqmc/include/config/Worms.h"
 
 //Achtung: es kann sein dass gewisse observabeln nicht gespeichert wurden, c.f. MonteCarlo.h
@@ -35,6 +41,12 @@ namespace meas {
         
         void add(std::vector<T> const& val, std::int64_t samples) {
             resize_add(val, data_, M()); samples_ += samples; for(std::size_t n = 0; n < val.size(); ++n) data_[n] += val[n];
+            if(binning() && std::is_same<M, Fix>::value && samples && chain() >= 0) bins_[chain()].add(val.data(), val.size(), 1./samples);
+        };
+        
+        void add(Vector const& other) {
+            resize_add(other.data_, data_, M()); samples_ += other.samples_; for(std::size_t n = 0; n < other.data_.size(); ++n) data_[n] += other.data_[n];
+            for(auto const& bins : other.bins_) bins_[bins.first].add(bins.second);
         };
         
         jsx::value reduce(double fact, All, bool b64) const {
@@ -68,10 +80,18 @@ namespace meas {
         std::size_t size() const {return data_.size();}
         T at(int const i) const {return data_[i];}
         
+        std::int64_t samples() const { return samples_;};
+        T const* data() const { return data_.data();};
+        
+        //by id of the Markov chain
+        std::map<std::int64_t, Binning<T>> const& bins() const { return bins_;};
+        std::map<std::int64_t, Binning<T>>& bins() { return bins_;};
+        
     private:
         
         std::int64_t samples_ = 0;
         io::Vector<T> data_;
+        std::map<std::int64_t, Binning<T>> bins_;
         
         static std::string name(double const&, Fix)               { return "meas::rvecfix"; };
         static std::string name(std::complex<double> const&, Fix) { return "meas::cvecfix"; };
@@ -125,37 +145,279 @@ namespace meas {
     //--------------------------------------------------------------------------------------------------------------------------------
     
     
-    std::int64_t reduce_steps(std::int64_t steps, All) {
-        mpi::reduce<mpi::op::sum>(steps, mpi::master); return steps;
-    };
-    
-    std::int64_t reduce_steps(std::int64_t steps, Jackknife) {
-        auto temp = steps; mpi::all_reduce<mpi::op::sum>(temp); return temp - steps;
-    };
-    
+    template<typename T>
+    inline void merge_vector(jsx::value& jOut, T const& in) {
+        if(jOut.is<jsx::empty_t>()) jOut = T();
+        jOut.at<T>().add(in);
+    }
     
-    template<typename E>
-    inline void reduce(jsx::value& jOut, double fact, jsx::value const& jIn, E, bool b64) {
+    //Adds the (not yet reduced) measurements jIn to jOut, e.g. those of Markov chains running on different threads of the same process
+    inline void merge(jsx::value& jOut, jsx::value const& jIn) {
         if(jIn.is<rvecfix>())
-            jOut = jIn.at<rvecfix>().reduce(fact, E(), b64);
+            merge_vector(jOut, jIn.at<rvecfix>());
         else if(jIn.is<cvecfix>())
-            jOut = jIn.at<cvecfix>().reduce(fact, E(), b64);
+            merge_vector(jOut, jIn.at<cvecfix>());
         else if(jIn.is<rvecvar>())
-            jOut = jIn.at<rvecvar>().reduce(fact, E(), b64);
+            merge_vector(jOut, jIn.at<rvecvar>());
         else if(jIn.is<cvecvar>())
-            jOut = jIn.at<cvecvar>().reduce(fact, E(), b64);
+            merge_vector(jOut, jIn.at<cvecvar>());
         else if(jIn.is<jsx::object_t>()) {
-            for(auto& jEntry : jIn.object()) reduce(jOut[jEntry.first], fact, jEntry.second, E(), b64);
+            for(auto& jEntry : jIn.object()) merge(jOut[jEntry.first], jEntry.second);
         } else if(jIn.is<jsx::array_t>()) {
-            if(!(jOut.is<jsx::array_t>() && jOut.size() == jIn.size())) jOut = jsx::array_t(jIn.size());
-            int index = 0; for(auto& jEntry : jIn.array()) reduce(jOut[index++], fact, jEntry, E(), b64);
+            if(jOut.is<jsx::empty_t>()) jOut = jsx::array_t(jIn.size());
+            if(!(jOut.is<jsx::array_t>() && jOut.size() == jIn.size())) throw std::runtime_error("meas::merge: missmatch in array size!");
+            int index = 0; for(auto& jEntry : jIn.array()) merge(jOut[index++], jEntry);
+        } else if(jOut.is<jsx::empty_t>())
+            jOut = jIn;
+    }
+    
+    
+    template<typename T, typename M>
+    inline jsx::value snapshot_vector(Vector<T, M> const& vec) {
+        io::Vector<T> data(vec.data(), vec.data() + vec.size());
+        jsx::value jBins = jsx::object_t(); for(auto const& bins : vec.bins()) jBins[std::to_string(bins.first)] = bins.second.json();
+        return jsx::object_t{{ Vector<T, M>::name(), jsx::object_t{{ "samples", vec.samples() }, { "data", std::move(data) }, { "binning", std::move(jBins) }}}};
+    }
+    
+    //Copy of the (not yet reduced) measurements, with the vectors replaced by {name: {"samples": samples, "data": io::rvec or io::cvec, "binning": {chain id: c.f. Binning.h}}}
+    inline jsx::value snapshot(jsx::value const& jIn) {
+        if(jIn.is<rvecfix>()) return snapshot_vector(jIn.at<rvecfix>());
+        if(jIn.is<cvecfix>()) return snapshot_vector(jIn.at<cvecfix>());
+        if(jIn.is<rvecvar>()) return snapshot_vector(jIn.at<rvecvar>());
+        if(jIn.is<cvecvar>()) return snapshot_vector(jIn.at<cvecvar>());
+        
+        if(jIn.is<jsx::object_t>()) {
+            jsx::value jOut = jsx::object_t();
+            for(auto const& jEntry : jIn.object()) jOut[jEntry.first] = snapshot(jEntry.second);
+            return jOut;
+        }
+        
+        if(jIn.is<jsx::array_t>()) {
+            jsx::value jOut = jsx::array_t();
+            for(auto const& jEntry : jIn.array()) jOut.array().push_back(snapshot(jEntry));
+            return jOut;
+        }
+        
+        return jIn;
+    }
+    
+    template<typename T, typename M>
+    inline void resume_vector(jsx::value const& jIn, jsx::value& jOut) {
+        jOut = Vector<T, M>();
+        jOut.at<Vector<T, M>>().add(jsx::at<io::Vector<T>>(jIn("data")), jIn("samples").int64());
+        if(jIn.is("binning"))
+            for(auto const& jBins : jIn("binning").object()) jOut.at<Vector<T, M>>().bins()[std::stoll(jBins.first)].restore(jBins.second, jOut.at<Vector<T, M>>().size());
+    }
+    
+    //Inverse of snapshot
+    inline void resume(jsx::value const& jIn, jsx::value& jOut) {
+        if(jIn.is<jsx::object_t>()) {
+            if(jIn.size() == 1) {
+                if(jIn.is(rvecfix::name())) return resume_vector<double, Fix>(jIn(rvecfix::name()), jOut);
+                if(jIn.is(cvecfix::name())) return resume_vector<std::complex<double>, Fix>(jIn(cvecfix::name()), jOut);
+                if(jIn.is(rvecvar::name())) return resume_vector<double, Var>(jIn(rvecvar::name()), jOut);
+                if(jIn.is(cvecvar::name())) return resume_vector<std::complex<double>, Var>(jIn(cvecvar::name()), jOut);
+            }
+            
+            jOut = jsx::object_t();
+            for(auto const& jEntry : jIn.object()) resume(jEntry.second, jOut[jEntry.first]);
+        } else if(jIn.is<jsx::array_t>()) {
+            jOut = jsx::array_t(jIn.size());
+            int index = 0; for(auto const& jEntry : jIn.array()) resume(jEntry, jOut[index++]);
         } else
             jOut = jIn;
     }
     
     
+    std::int64_t reduce_steps(std::int64_t steps, All) {
+        mpi::reduce<mpi::op::sum>(steps, mpi::master); return steps;
+    };
+    
+    std::int64_t reduce_steps(std::int64_t steps, Jackknife) {
+        auto temp = steps; mpi::all_reduce<mpi::op::sum>(temp); return temp - steps;
+    };
+    
+    
+    //Streams leafs of the given sizes (in doubles) through a send and a receive buffer of at most capacity doubles each (no receive buffer
+    //if receive is false), with one call of collective(send, recv, size) per buffer. pack(leaf, offset, send, n) fills the send buffer,
+    //unpack(leaf, offset, recv, send, n) takes the reduced entries, and open(leaf) and close(leaf) are called before the first and after
+    //the last entry of each leaf, also if it is empty.
+    template<typename Collective, typename Pack, typename Open, typename Unpack, typename Close>
+    inline void stream(std::vector<std::size_t> const& sizes, std::size_t capacity, bool receive, Collective collective, Pack pack, Open open, Unpack unpack, Close close) {
+        struct Cursor {
+            std::size_t leaf = 0, offset = 0;
+        };
+        
+        std::size_t total = 0; for(auto size : sizes) total += size;
+        
+        std::vector<double> send(std::min(capacity, total)), recv(receive ? send.size() : 0);
+        Cursor packed, unpacked;
+        
+        for(std::size_t begin = 0; begin < total; begin += send.size()) {
+            std::size_t const size = std::min(send.size(), total - begin);
+            
+            for(std::size_t pos = 0; pos < size; ) {
+                std::size_t const n = std::min(sizes[packed.leaf] - packed.offset, size - pos);
+                pack(packed.leaf, packed.offset, send.data() + pos, n); pos += n; packed.offset += n;
+                if(packed.offset == sizes[packed.leaf]) { ++packed.leaf; packed.offset = 0;}
+            }
+            
+            collective(send.data(), recv.data(), size);
+            
+            for(std::size_t pos = 0; pos < size; ) {
+                if(unpacked.offset == 0) open(unpacked.leaf);
+                std::size_t const n = std::min(sizes[unpacked.leaf] - unpacked.offset, size - pos);
+                unpack(unpacked.leaf, unpacked.offset, receive ? recv.data() + pos : nullptr, send.data() + pos, n); pos += n; unpacked.offset += n;
+                if(unpacked.offset == sizes[unpacked.leaf]) { close(unpacked.leaf++); unpacked.offset = 0;}
+            }
+        }
+        
+        for(; unpacked.leaf < sizes.size(); ++unpacked.leaf) {
+            open(unpacked.leaf); close(unpacked.leaf);
+        }
+    }
+    
+    
+    //Reduction of all vectors of a measurement tree. The vectors are streamed through a send and a receive buffer which together take at most
+    //"memory" bytes (complex entries as two doubles), and each buffer is reduced with one collective instead of one collective per vector.
+    //The samples and the sizes of the variable length vectors are reduced with one collective each. The tree has to have the same structure
+    //on all ranks, and jOut may be jIn (the vectors are then replaced one after the other, as soon as they are reduced).
+    
+    struct Reduce {
+        Reduce() = delete;
+        explicit Reduce(std::size_t memory) : capacity_(std::max<std::size_t>(memory/(2*sizeof(double)), 1)) {};
+        Reduce(Reduce const&) = delete;
+        Reduce(Reduce&&) = delete;
+        Reduce& operator=(Reduce const&) = delete;
+        Reduce& operator=(Reduce&&) = delete;
+        ~Reduce() = default;
+        
+        void add(jsx::value& jOut, double fact, jsx::value const& jIn) {
+            if(jIn.is<rvecfix>())
+                add_leaf(jOut, fact, jIn.at<rvecfix>());
+            else if(jIn.is<cvecfix>())
+                add_leaf(jOut, fact, jIn.at<cvecfix>());
+            else if(jIn.is<rvecvar>())
+                add_leaf(jOut, fact, jIn.at<rvecvar>());
+            else if(jIn.is<cvecvar>())
+                add_leaf(jOut, fact, jIn.at<cvecvar>());
+            else if(jIn.is<jsx::object_t>()) {
+                for(auto& jEntry : jIn.object()) add(jOut[jEntry.first], fact, jEntry.second);
+            } else if(jIn.is<jsx::array_t>()) {
+                if(!(jOut.is<jsx::array_t>() && jOut.size() == jIn.size())) jOut = jsx::array_t(jIn.size());
+                int index = 0; for(auto& jEntry : jIn.array()) add(jOut[index++], fact, jEntry);
+            } else
+                jOut = jIn;
+        };
+        
+        template<typename E>
+        void operator()(E, bool b64) {
+            std::vector<std::size_t> sizes; std::vector<std::int64_t> samples;
+            for(auto const& leaf : leafs_) {
+                sizes.push_back(leaf.size); samples.push_back(leaf.samples);
+            }
+            
+            mpi::all_reduce<mpi::op::max>(sizes);
+            reduce_samples(samples, E());
+            
+            for(std::size_t i = 0; i < leafs_.size(); ++i) {
+                leafs_[i].samples = samples[i]; leafs_[i].size = sizes[i];
+            }
+            
+            receive_ = receives(E());
+            
+            stream(sizes, capacity_, receive_,
+                   [](double const* send, double* recv, std::size_t size) { reduce(send, recv, size, E());},
+                   [&](std::size_t l, std::size_t offset, double* send, std::size_t n) {
+                       for(std::size_t i = 0; i < n; ++i, ++offset) send[i] = offset < leafs_[l].own ? leafs_[l].data[offset] : .0;
+                   },
+                   [&](std::size_t l) { open(leafs_[l]);},
+                   [&](std::size_t l, std::size_t offset, double const* recv, double const* send, std::size_t n) {
+                       if(receive_) copy(result_ + offset, recv, send, n, E());
+                   },
+                   [&](std::size_t l) { close(leafs_[l], E(), b64);});
+            
+            leafs_.clear();
+        };
+        
+    private:
+        struct Leaf {
+            jsx::value* dest; double fact; std::string (*name)();
+            bool complex; double const* data; std::size_t own;   // own = size of the local vector (in doubles)
+            std::size_t size; std::int64_t samples;
+        };
+        
+        std::size_t const capacity_;
+        std::vector<Leaf> leafs_;
+        
+        bool receive_ = false;
+        io::rvec rresult_; io::cvec cresult_; double* result_ = nullptr;
+        
+        template<typename T, typename M>
+        void add_leaf(jsx::value& jOut, double fact, Vector<T, M> const& vec) {
+            Leaf leaf; std::size_t const doubles = sizeof(T)/sizeof(double);
+            leaf.dest = &jOut; leaf.fact = fact; leaf.name = &Vector<T, M>::name;
+            leaf.complex = doubles == 2; leaf.data = reinterpret_cast<double const*>(vec.data()); leaf.own = leaf.size = doubles*vec.size();
+            leaf.samples = vec.samples();
+            leafs_.push_back(leaf);
+        };
+        
+        void open(Leaf const& leaf) {
+            if(!receive_) return;
+            if(leaf.complex) {
+                cresult_ = io::cvec(leaf.size/2); result_ = reinterpret_cast<double*>(cresult_.data());
+            } else {
+                rresult_ = io::rvec(leaf.size); result_ = rresult_.data();
+            }
+        };
+        
+        template<typename E>
+        void close(Leaf const& leaf, E, bool b64) {
+            if(receive_) {
+                if(!leaf.samples) throw std::runtime_error(leaf.name() + "::write: no measurements taken !");
+                if(leaf.complex)
+                    write(*leaf.dest, cresult_, leaf.fact/leaf.samples, b64);
+                else
+                    write(*leaf.dest, rresult_, leaf.fact/leaf.samples, b64);
+            } else
+                *leaf.dest = jsx::null_t();
+        };
+        
+        template<typename T>
+        static void write(jsx::value& jDest, io::Vector<T>& data, double fact, bool b64) {
+            for(auto& x : data) x *= fact;
+            data.b64() = b64; jDest = std::move(data);
+        };
+        
+        static void reduce_samples(std::vector<std::int64_t>& samples, All) {
+            mpi::reduce<mpi::op::sum>(samples, mpi::master);
+        };
+        static void reduce_samples(std::vector<std::int64_t>& samples, Jackknife) {
+            auto own = samples; mpi::all_reduce<mpi::op::sum>(samples);
+            for(std::size_t i = 0; i < samples.size(); ++i) samples[i] -= own[i];
+        };
+        
+        static bool receives(All) { return mpi::rank() == mpi::master;};
+        static bool receives(Jackknife) { return true;};
+        
+        static void reduce(double const* send, double* recv, std::size_t size, All) {
+            mpi::reduce<mpi::op::sum>(send, recv, size, mpi::master);
+        };
+        static void reduce(double const* send, double* recv, std::size_t size, Jackknife) {
+            mpi::all_reduce<mpi::op::sum>(send, recv, size);
+        };
+        
+        static void copy(double* dest, double const* recv, double const* send, std::size_t size, All) {
+            std::copy(recv, recv + size, dest);
+        };
+        static void copy(double* dest, double const* recv, double const* send, std::size_t size, Jackknife) {
+            for(std::size_t i = 0; i < size; ++i) dest[i] = recv[i] - send[i];
+        };
+    };
+    
+    
     template<typename E>
-    inline void reduce(jsx::value& jOut, jsx::value const& jIn, jsx::value const& jEtas, E, bool b64) {
+    inline void reduce(jsx::value& jOut, jsx::value const& jIn, jsx::value const& jEtas, E, bool b64, std::size_t memory) {
         auto const pName = cfg::partition::Worm::name();
         
         jsx::value const jSign = jIn(pName)("sign").at<rvecfix>().reduce(1., E(), b64);
@@ -164,18 +426,252 @@ namespace meas {
         
         if(!jOut.is<jsx::object_t>()) jOut = jsx::object_t();
         
+        Reduce vectors(memory); std::map<std::string, std::int64_t> steps;
+        
         for(auto& jWorm : jIn.object()) {
-            auto const wSteps = reduce_steps(jWorm.second("steps").int64(), E());
+            auto const wSteps = steps[jWorm.first] = reduce_steps(jWorm.second("steps").int64(), E());
             auto const Zw = wSteps/jEtas(jWorm.first).real64();
             
-            reduce(jOut[jWorm.first], Zw/signxZp, jWorm.second, E(), b64);
-            
-            jOut[jWorm.first]["steps"] = wSteps;
+            vectors.add(jOut[jWorm.first], Zw/signxZp, jWorm.second);
         }
         
+        vectors(E(), b64);
+        
+        for(auto const& wSteps : steps) jOut[wSteps.first]["steps"] = wSteps.second;
+        
         jOut[pName]["sign"] = jSign;
     }
 
+    //Binning analysis of the pooled bins of all Markov chains and ranks for the fixed size vectors of measurement trees. As in Reduce, the bins
+    //(counts, sums and squares of all levels) are streamed through buffers of at most "memory" bytes, each reduced with one collective, and the
+    //sizes and numbers of levels of all vectors are reduced with one collective. The bins of the chains are pooled one vector at a time while
+    //packing. The results come back in the order the vectors were added (c.f. binning), on master only (null on the other ranks).
+    
+    struct BinningReduce {
+        BinningReduce() = delete;
+        explicit BinningReduce(std::size_t memory) : capacity_(std::max<std::size_t>(memory/(2*sizeof(double)), 1)) {};
+        BinningReduce(BinningReduce const&) = delete;
+        BinningReduce(BinningReduce&&) = delete;
+        BinningReduce& operator=(BinningReduce const&) = delete;
+        BinningReduce& operator=(BinningReduce&&) = delete;
+        ~BinningReduce() = default;
+        
+        void add(double fact, jsx::value const& jIn) {
+            if(jIn.is<rvecfix>())
+                add_leaf(fact, jIn, jIn.at<rvecfix>());
+            else if(jIn.is<cvecfix>())
+                add_leaf(fact, jIn, jIn.at<cvecfix>());
+            else if(jIn.is<jsx::object_t>()) {
+                for(auto& jEntry : jIn.object()) add(fact, jEntry.second);
+            } else if(jIn.is<jsx::array_t>()) {
+                for(auto& jEntry : jIn.array()) add(fact, jEntry);
+            }
+        };
+        
+        void operator()() {
+            std::vector<std::size_t> dims;
+            for(auto const& leaf : leafs_) {
+                dims.push_back(leaf.size); dims.push_back(leaf.levels);
+            }
+            
+            mpi::all_reduce<mpi::op::max>(dims);
+            
+            std::vector<std::size_t> sizes;
+            for(std::size_t i = 0; i < leafs_.size(); ++i) {
+                auto& leaf = leafs_[i]; leaf.size = dims[2*i]; leaf.levels = dims[2*i + 1];
+                sizes.push_back(leaf.complex ? Binning<std::complex<double>>::packed(leaf.levels, leaf.size) : Binning<double>::packed(leaf.levels, leaf.size));
+            }
+            
+            bool const receive = mpi::rank() == mpi::master;
+            
+            stream(sizes, capacity_, receive,
+                   [](double const* send, double* recv, std::size_t size) { mpi::reduce<mpi::op::sum>(send, recv, size, mpi::master);},
+                   [&](std::size_t l, std::size_t offset, double* send, std::size_t n) {
+                       if(offset == 0) pack(leafs_[l]);
+                       std::copy_n(packed_.data() + offset, n, send);
+                   },
+                   [&](std::size_t l) { if(receive) received_.assign(sizes[l], .0);},
+                   [&](std::size_t l, std::size_t offset, double const* recv, double const* send, std::size_t n) {
+                       if(receive) std::copy_n(recv, n, received_.data() + offset);
+                   },
+                   [&](std::size_t l) { results_.push_back(receive ? result(leafs_[l]) : jsx::null_t());});
+            
+            leafs_.clear(); packed_.clear(); received_.clear(); next_ = 0;
+        };
+        
+        jsx::value next() {
+            if(next_ == results_.size()) throw std::runtime_error("meas::BinningReduce::next: no result left");
+            return std::move(results_[next_++]);
+        };
+        
+    private:
+        struct Leaf {
+            double fact; bool complex; jsx::value const* vec;
+            std::size_t size, levels;   // size in entries
+        };
+        
+        std::size_t const capacity_;
+        std::vector<Leaf> leafs_;
+        std::vector<double> packed_, received_;
+        std::vector<jsx::value> results_; std::size_t next_ = 0;
+        
+        template<typename T>
+        void add_leaf(double fact, jsx::value const& jVec, Vector<T, Fix> const& vec) {
+            std::size_t levels = 0; for(auto const& bins : vec.bins()) levels = std::max(levels, bins.second.levels());
+            leafs_.push_back({ fact, !std::is_same<T, double>::value, &jVec, vec.size(), levels });
+        };
+        
+        void pack(Leaf const& leaf) {
+            if(leaf.complex) pack(leaf, leaf.vec->at<cvecfix>()); else pack(leaf, leaf.vec->at<rvecfix>());
+        };
+        
+        template<typename T>
+        void pack(Leaf const& leaf, Vector<T, Fix> const& vec) {
+            Binning<T> all; for(auto const& bins : vec.bins()) all.add(bins.second);
+            packed_.assign(Binning<T>::packed(leaf.levels, leaf.size), .0); all.pack(leaf.levels, leaf.size, packed_.data());
+        };
+        
+        jsx::value result(Leaf const& leaf) const {
+            if(leaf.complex) return Binning<std::complex<double>>::result(received_.data(), leaf.levels, leaf.size, leaf.fact);
+            return Binning<double>::result(received_.data(), leaf.levels, leaf.size, leaf.fact);
+        };
+    };
+    
+    //With chain < 0 the result for the pooled bins is taken from combined, otherwise the bins of chain are analysed locally
+    template<typename T, typename M>
+    inline void binning_leaf(jsx::value& jOut, double fact, Vector<T, M> const& vec, std::int64_t chain, BinningReduce& combined) {
+        jsx::value jLeaf;
+        if(chain < 0)
+            jLeaf = combined.next();
+        else if(vec.bins().count(chain))
+            jLeaf = vec.bins().at(chain).analyse_local(fact, vec.size());
+        
+        if(!jLeaf.is<jsx::null_t>() && !jLeaf.is<jsx::empty_t>()) jOut = std::move(jLeaf);
+    }
+    
+    //jOut stays empty for subtrees without fixed size vectors
+    inline void binning(jsx::value& jOut, double fact, jsx::value const& jIn, std::int64_t chain, BinningReduce& combined) {
+        if(jIn.is<rvecfix>())
+            binning_leaf(jOut, fact, jIn.at<rvecfix>(), chain, combined);
+        else if(jIn.is<cvecfix>())
+            binning_leaf(jOut, fact, jIn.at<cvecfix>(), chain, combined);
+        else if(jIn.is<jsx::object_t>()) {
+            for(auto& jEntry : jIn.object()) {
+                jsx::value jEntryOut; binning(jEntryOut, fact, jEntry.second, chain, combined);
+                if(!jEntryOut.is<jsx::empty_t>()) jOut[jEntry.first] = std::move(jEntryOut);
+            }
+        } else if(jIn.is<jsx::array_t>()) {
+            jsx::value jArray = jsx::array_t(jIn.size()); bool any = false;
+            int index = 0; for(auto& jEntry : jIn.array()) {
+                binning(jArray[index], fact, jEntry, chain, combined); any = any || !jArray[index++].is<jsx::empty_t>();
+            }
+            for(auto& jEntry : jArray.array()) if(jEntry.is<jsx::empty_t>()) jEntry = jsx::null_t();
+            if(any) jOut = std::move(jArray);
+        }
+    }
+    
+    //Ids of the Markov chains with bins on this rank
+    inline void binning_chains(jsx::value const& jIn, std::set<std::int64_t>& chains) {
+        if(jIn.is<rvecfix>())
+            for(auto const& bins : jIn.at<rvecfix>().bins()) chains.insert(bins.first);
+        else if(jIn.is<cvecfix>())
+            for(auto const& bins : jIn.at<cvecfix>().bins()) chains.insert(bins.first);
+        else if(jIn.is<jsx::object_t>())
+            for(auto& jEntry : jIn.object()) binning_chains(jEntry.second, chains);
+        else if(jIn.is<jsx::array_t>())
+            for(auto& jEntry : jIn.array()) binning_chains(jEntry, chains);
+    }
+    
+    //The per chain results of all ranks on master, as json text padded to the same length
+    inline jsx::value gather_chains(jsx::value const& jChains) {
+        std::ostringstream stream; stream << std::setprecision(10); jsx::write(jChains, stream);
+        std::string buffer = stream.str();
+        
+        std::size_t length = buffer.size();  mpi::all_reduce<mpi::op::max>(length);
+        buffer.resize(length, ' ');  mpi::gather(buffer, mpi::master);
+        
+        if(mpi::rank() != mpi::master) return jsx::null_t();
+        
+        jsx::value jOut = jsx::object_t();
+        for(std::size_t pos = 0; pos < buffer.size(); pos += length) {
+            std::string const text = buffer.substr(pos, length);
+            jsx::value jRank; jsx::parse(text.c_str(), jRank);
+            for(auto& jChain : jRank.object()) jOut[jChain.first] = std::move(jChain.second);
+        }
+        return jOut;
+    }
+    
+    //Binning analysis of the (not yet reduced) measurements with "binning" : true (c.f. Binning.h), collective. On master it returns {"combined": tree,
+    //"chains": {id: tree}}, with tree the tree of the fixed size vectors, each replaced by its error and autocorrelation time, for the pooled bins of all
+    //Markov chains and for each chain. The errors are normalised as the means in reduce, but without the fluctuations of the sign and of the worm space volumes.
+    //The pooled bins are reduced with BinningReduce, through buffers of at most "memory" bytes.
+    inline jsx::value binning(jsx::value const& jIn, jsx::value const& jEtas, std::size_t memory) {
+        auto const pName = cfg::partition::Worm::name();
+        
+        jsx::value const jSign = jIn(pName)("sign").at<rvecfix>().reduce(1., All(), false);
+        auto const pSteps = reduce_steps(jIn(pName)("steps").int64(), All());
+        auto const signxZp = (jSign.is<jsx::null_t>() ? 1. : jsx::at<io::rvec>(jSign).at(0))*pSteps/jEtas(pName).real64();
+        
+        std::set<std::int64_t> chains; binning_chains(jIn, chains);
+        
+        std::map<std::string, double> Zw; BinningReduce combined(memory);
+        
+        for(auto& jWorm : jIn.object()) {
+            Zw[jWorm.first] = reduce_steps(jWorm.second("steps").int64(), All())/jEtas(jWorm.first).real64();
+            
+            for(auto& jEntry : jWorm.second.object())
+                combined.add(jWorm.first == pName && jEntry.first == "sign" ? 1. : Zw[jWorm.first]/signxZp, jEntry.second);
+        }
+        
+        combined();
+        
+        jsx::value jCombined = jsx::object_t(), jChains = jsx::object_t();
+        
+        for(auto& jWorm : jIn.object()) {
+            for(auto& jEntry : jWorm.second.object()) {
+                double const fact = jWorm.first == pName && jEntry.first == "sign" ? 1. : Zw[jWorm.first]/signxZp;
+                
+                jsx::value jEntryOut; binning(jEntryOut, fact, jEntry.second, -1, combined);
+                if(!jEntryOut.is<jsx::empty_t>()) jCombined[jWorm.first][jEntry.first] = std::move(jEntryOut);
+                
+                for(auto chain : chains) {
+                    jsx::value jChainOut; binning(jChainOut, fact, jEntry.second, chain, combined);
+                    if(!jChainOut.is<jsx::empty_t>()) jChains[std::to_string(chain)][jWorm.first][jEntry.first] = std::move(jChainOut);
+                }
+            }
+        }
+        
+        jChains = gather_chains(jChains);
+        
+        if(mpi::rank() != mpi::master) return jsx::null_t();
+        
+        return jsx::object_t{{ "combined", std::move(jCombined) }, { "chains", std::move(jChains) }};
+    }
+
+    //The measurements are written to name.json, or to name.bin with "output format" : "binary"
+    inline bool binary(jsx::value const& jParams) {
+        std::string const format = jParams.is("output format") ? jParams("output format").string() : "json";
+        if(format != "json" && format != "binary") throw std::runtime_error("meas::binary: invalid output format " + format);
+        return format == "binary";
+    }
+    
+    inline void write(jsx::value const& jParams, jsx::value const& jMeasurements, std::string const& name, bool all = false) {
+        if(binary(jParams)) {
+            if(all || mpi::rank() == mpi::master) io::binary::write(jMeasurements, name + ".bin");
+        } else if(all)
+            jsx::write(jMeasurements, name + ".json");
+        else
+            mpi::write(jMeasurements, name + ".json");
+    }
+    
+    //Returns the measurements with io::rvec and io::cvec values (i.e. after io::from_tagged_json)
+    inline jsx::value read(jsx::value const& jParams, std::string const& name) {
+        if(binary(jParams)) return io::binary::read(name + ".bin");
+        
+        jsx::value jMeasurements = mpi::read(name + ".json");  io::from_tagged_json(jMeasurements);
+        return jMeasurements;
+    }
+
 std::vector<std::string> split_by_char(std::string const& string, char const c){
     std::stringstream temp(string);
     std::string segment;
@@ -284,7 +780,7 @@ std::vector<std::string> split_by_char(std::string const& string, char const c){
         if (mpi::number_of_workers() > 1)
             for(auto& space : jMeasurements.object())
                 if (jParams.is(space.first) and space.first != cfg::partition::Worm::name()){
-                    if (jParams(space.first)("basis").string() == "matsubara")
+                    if (jParams(space.first)("basis").string() == "matsubara" || jParams(space.first)("basis").string() == "nfft")
                         check_missing_tensor_elements<cvecfix,ut::complex>(space.first, space.second);
                     else if (jParams(space.first)("basis").string() == "legendre")
                         check_missing_tensor_elements<Vector<Value,Fix>,Value>(space.first, space.second);
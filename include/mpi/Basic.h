@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 #include <complex>
+#include <algorithm>
 
 //--------------------------------------------------schö tö tiä tü mö tiä par la barbischätöööötötötötö-------------------------------------------------------
 
@@ -184,8 +185,28 @@ namespace mpi {
         arg = std::move(result);
 #endif
     };
- 
-    
+
+
+    //recv[0, size) = sum (or ...) over the ranks of send[0, size), recv is only written on root
+    template<typename Op, typename T, typename std::enable_if<data_op_compatible<T, Op>::value, int>::type = 0>
+    void reduce(T const* send, T* recv, std::size_t size, int root) {
+#ifdef HAVE_MPI
+        MPI_Reduce(send, recv, size, get_data_type(T()), get_op(Op()), root, MPI_COMM_WORLD);
+#else
+        std::copy(send, send + size, recv);
+#endif
+    };
+
+    template<typename Op, typename T, typename std::enable_if<data_op_compatible<T, Op>::value, int>::type = 0>
+    void all_reduce(T const* send, T* recv, std::size_t size) {
+#ifdef HAVE_MPI
+        MPI_Allreduce(send, recv, size, get_data_type(T()), get_op(Op()), MPI_COMM_WORLD);
+#else
+        std::copy(send, send + size, recv);
+#endif
+    };
+
+
     template<typename T, typename std::enable_if<data_compatible_if< T, fundamental >::value, int>::type = 0>
     void bcast(T& arg, int root) {
 #ifdef HAVE_MPI
@@ -22,7 +22,7 @@ struct OneTimeWormDefaults : Defaults {
         
         defaults_["cutoff"] = 50; // number of frequencies to measure
         defaults_["matsubara cutoff"] = 50; // number of frequencies to output in evalsim (used in legendre basis"
-        defaults_["basis"] = "matsubara"; // basis in which to measure (only matsubara for susceptibilities atm)
+        defaults_["basis"] = "matsubara"; // basis in which to measure: matsubara, nfft or legendre (only matsubara and nfft for susceptibilities atm)
         defaults_["meas"] = jsx::array_t({"imprsum"}); //use improved estimators/not (["imprsum"/""]) (improved estimators not implemented for susceptibilities)
         defaults_["sweep"] = 50;
         defaults_["store"] = 100;
@@ -38,11 +38,12 @@ struct MultiTimeWormDefaults : Defaults {
         defaults_["fermion cutoff"] = 50; // number of frequencies to measure
         defaults_["boson cutoff"] = 10; // number of frequencies to measure
         defaults_["matsubara cutoff"] = 50; // number of frequencies to output in evalsim (used in legendre basis"
-        defaults_["basis"] = "matsubara"; // basis in which to measure (only matsubara for susceptibilities atm)
+        defaults_["basis"] = "matsubara"; // basis in which to measure: matsubara, nfft (not for the four-time worms) or legendre
         defaults_["meas"] = jsx::array_t({"imprsum"}); //use improved estimators/not (["imprsum"/""]) (improved estimators not implemented for susceptibilities)
         defaults_["sweep"] = 50;
         defaults_["store"] = 100;
         defaults_["full"] = true; //compute the full vertex -- only effects the "vertex x" worms and "kernels" block
+        defaults_["buffer"] = 0; //number of samples collected before they are added with one matrix product -- only effects the four-time worms (0: add directly)
         
     }
         
@@ -85,10 +86,18 @@ struct MainDefaults : Defaults{
         defaults_["restart"] = false;
         defaults_["partition fraction"] = 0.5;
         defaults_["sim per device"] = 0;
+        defaults_["threads"] = 1;
+        defaults_["sector threads"] = 1;  // threads per Markov chain for the sectors of a proposal (cpu version)
+        defaults_["propagator cache"] = 0;
         defaults_["measurement time"] = 20;
         defaults_["thermalisation time"] = 5;
         defaults_["error"] = "parallel";
         defaults_["all errors"] = false;
+        defaults_["binning"] = false;
+        defaults_["precision"] = "double"; // "mixed" does the products of the trace in single precision (cpu version)
+        defaults_["precision check"] = 1000;
+        defaults_["precision tolerance"] = 1.e-3;
+        defaults_["output format"] = "json"; // format of the measurements: json or binary (c.f. io/Binary.h)
         defaults_["quad insert"] = false;
         defaults_["seed"] = 41085;
         defaults_["seed inc"] = 857;
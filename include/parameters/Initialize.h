@@ -126,7 +126,7 @@ void check_type_against_default(std::string const& entry, jsx::value const& val,
                    
                    auto & jWorm = jParams[W::name()];
                    
-                   if (jWorm.is("fermion cutoff") and jWorm("basis").string() == "matsubara" ) jWorm["fermion cutoff"] = fermion_cutoff;
+                   if (jWorm.is("fermion cutoff") and (jWorm("basis").string() == "matsubara" || jWorm("basis").string() == "nfft") ) jWorm["fermion cutoff"] = fermion_cutoff;
                    if (jWorm.is("matsubara cutoff")) jWorm["matsubara cutoff"] = fermion_cutoff;
                    
                    if (jWorm.is("cutoff")) jWorm["cutoff"] = boson_cutoff;